@@ -1,12 +1,36 @@
 #pragma once
 
-// Template class for queues
+#include <atomic>
+#include <cstddef>
+
+// Type-erased queue interface, for code that picks a queue at runtime. Queues don't derive from it: job systems use
+// them through their concrete type (see IsQueue in QueueTraits.h), and VirtualDispatch wraps any queue in it.
 template<typename T>
 class IQueue {
 public:
+    virtual ~IQueue() = default;
+
     // Enqueues value.
     virtual void Enqueue(const T& value) = 0;
 
     // Dequeues a value and stores in out. Returns false if the queue is empty, otherwise true.
     virtual bool Dequeue(T& out) = 0;
-};
\ No newline at end of file
+
+    // Enqueues count values starting at values.
+    virtual void EnqueueBulk(const T* values, size_t count) = 0;
+
+    // Dequeues up to max values into out. Returns the number of values dequeued (0 if the queue is empty).
+    virtual size_t DequeueBulk(T* out, size_t max) = 0;
+
+    // Enqueues value unless the queue drops it. Returns false if it was dropped, queues that never drop return true.
+    virtual bool TryEnqueue(const T& value) = 0;
+
+    // Enqueues values until the queue drops one. Returns the number enqueued, the rest were not.
+    virtual size_t TryEnqueueBulk(const T* values, size_t count) = 0;
+
+    // Enqueues value, waiting for room while the queue is full until running turns false. Returns false if it gave up.
+    virtual bool EnqueueWhile(const T& value, const std::atomic<bool>& running) = 0;
+
+    // Enqueues count values, waiting for room like EnqueueWhile. Returns the number enqueued.
+    virtual size_t EnqueueBulkWhile(const T* values, size_t count, const std::atomic<bool>& running) = 0;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <atomic>
+
+// Link embedded in items of intrusive queues (see IntrusiveMPSCQueue), so enqueueing needs no allocation.
+// An item can only be in one such queue once at a time: the enqueuer claims it with TryLink and the queue releases it
+// when it is dequeued.
+struct IntrusiveMPSCHook {
+    std::atomic<IntrusiveMPSCHook*> mpscNext{nullptr};
+    std::atomic<bool> linked{false};
+
+    // Claims the item for enqueueing. Returns false if it is still in a queue.
+    bool TryLink() {
+        return !linked.load(std::memory_order_relaxed) && !linked.exchange(true, std::memory_order_acquire);
+    }
+};
\ No newline at end of file
@@ -1,12 +1,9 @@
 #pragma once
 
-#include <chrono>
+#include "IntrusiveMPSCHook.h"
 
-// Job structure
-struct Job {
+// Job structure, carries its own link so intrusive queues can hold it without allocating
+struct Job : IntrusiveMPSCHook {
     virtual ~Job() = default;
     virtual void operator()() = 0;
-
-    // Holds time stamp variable
-    std::chrono::high_resolution_clock::time_point enqueueTime;
 };
\ No newline at end of file
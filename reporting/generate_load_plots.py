@@ -0,0 +1,65 @@
+import pandas as pd
+import matplotlib.pyplot as plt
+import os
+import glob
+
+results_dir = "results/load_latency"
+plots_dir = "plots/load_latency"
+os.makedirs(plots_dir, exist_ok=True)
+
+csv_files = glob.glob(os.path.join(results_dir, "*.csv"))
+
+if not csv_files:
+    print(f"No CSV files found in {results_dir}")
+    exit()
+
+for file_path in csv_files:
+    print(f"Processing {file_path}...")
+    # Read and process the data
+    try:
+        data = pd.read_csv(file_path)
+    except FileNotFoundError:
+        print(f"Error: The file {file_path} was not found.")
+        continue
+
+    data = data.loc[:, ~data.columns.str.contains("^Unnamed")]
+    latency_columns = [("Average Latency (ns)", "average"), ("p99 Latency (ns)", "p99"), ("Corrected p99 Latency (ns)", "corrected_p99")]
+    for column in ["Producer/Consumer Count", "Offered Load (jobs/sec)"] + [column for column, _ in latency_columns]:
+        data[column] = pd.to_numeric(data[column], errors="coerce")
+    data = data.dropna(subset=["Producer/Consumer Count", "Offered Load (jobs/sec)"] + [column for column, _ in latency_columns] + ["Queue"])
+
+    if data.empty:
+        print(f"Skipping {file_path} due to no valid data.")
+        continue
+
+    job_count_str = os.path.basename(file_path).replace("load_job_count_", "").replace(".csv", "")
+
+    # One plot per thread count and latency column, latency vs offered load for each queue
+    for thread_count in sorted(data["Producer/Consumer Count"].unique()):
+        for column, short_name in latency_columns:
+            plt.figure()
+
+            for queue_type in data["Queue"].unique():
+                subset = data[(data["Queue"] == queue_type) & (data["Producer/Consumer Count"] == thread_count)]
+                subset = subset.sort_values("Offered Load (jobs/sec)")
+                if subset.empty:
+                    continue
+                plt.plot(subset["Offered Load (jobs/sec)"], subset[column], marker="o", linestyle="-", label=queue_type)
+
+            # Configure and save the plot
+            plt.title(f"{column.replace(' (ns)', '')} vs. Offered Load ({int(thread_count)} P/C, {job_count_str} Jobs)")
+            plt.xlabel("Offered Load (jobs/sec)")
+            plt.ylabel(column)
+            plt.xscale("log")
+            plt.yscale("log")
+            plt.legend()
+            plt.grid(True, which="both", ls=":")
+            plt.tight_layout()
+
+            filename = os.path.join(plots_dir, f"offered_load_vs_{short_name}_latency_{int(thread_count)}_threads_{job_count_str}.png")
+            plt.savefig(filename)
+            print(f"Saved plot to {filename}")
+
+            # Show and close the figure
+            # plt.show() # Commented out to not block for each plot
+            plt.close()
@@ -1,20 +1,28 @@
 #pragma once
 
-#include <vector>
-
-#define ENABLE_THROUGHPUT_BENCHMARK
-#define THROUGHPUT_CONFIG defaultThroughputConfig
-#define THROUGHPUT_BASEPATH "../reporting/results/throughput/throughput"
+#include "Evaluation/Arrivals.h"
 
-#define ENABLE_LATENCY_BENCHMARK
-#define LATENCY_CONFIG defaultLatencyConfig
-#define LATENCY_BASEPATH "../reporting/results/latency/latency"
+#include <string>
+#include <vector>
 
 struct BenchmarkSuiteConfig {
     int iterations;
     std::vector<size_t> jobCounts;
     std::vector<int> producerCounts;
     std::vector<int> consumerCounts;
+    size_t batchSize = 1; // jobs moved per EnqueueBulk/DequeueBulk call, 1 uses single Enqueue/Dequeue
+    // unmeasured iterations run before each configuration's measured ones, so caches, allocator and CPU clocks have
+    // settled by the first sample
+    int warmupIterations = 1;
+    // throughput and latency suites keep running iterations past `iterations`, up to maxIterations, until the 95%
+    // confidence interval of the mean is within ±targetConfidence of it (see SampleStats). 0 runs exactly `iterations`.
+    int maxIterations = 0;
+    double targetConfidence = 0.02;
+    // queues with a runtime capacity run once per capacity, empty runs them at their default capacity
+    std::vector<size_t> capacities = {};
+    // load suites only: how producers space out jobs, and the total jobs/sec offered to the queue in each run
+    ArrivalPattern arrivalPattern = ArrivalPattern::Poisson;
+    std::vector<double> offeredLoads = {};
 };
 
 static BenchmarkSuiteConfig defaultThroughputConfig {
@@ -22,6 +30,10 @@ static BenchmarkSuiteConfig defaultThroughputConfig {
     { (size_t)1E6, (size_t)5E6, (size_t)1E7 }, // jobCounts
     { 1, 2, 4, 6, 8 },                         // producerCounts
     { 1, 2, 4, 6, 8 },                         // consumerCounts
+    1,                                         // batchSize
+    1,                                         // warmupIterations
+    12,                                        // maxIterations
+    0.02,                                      // targetConfidence
 };
 
 static BenchmarkSuiteConfig defaultLatencyConfig {
@@ -29,4 +41,173 @@ static BenchmarkSuiteConfig defaultLatencyConfig {
     { (size_t)1E5, (size_t)5E5, (size_t)1E6 }, // jobCounts
     { 1, 2, 4, 6, 8 },                         // producerCounts
     { 1, 2, 4, 6, 8 },                         // consumerCounts
+    1,                                         // batchSize
+    1,                                         // warmupIterations
+    12,                                        // maxIterations
+    0.02,                                      // targetConfidence
 };
+
+// N producers feeding a single consumer, like an aggregation stage
+static BenchmarkSuiteConfig oneConsumerThroughputConfig {
+    6,                                         // iterations
+    { (size_t)1E6, (size_t)5E6, (size_t)1E7 }, // jobCounts
+    { 1, 2, 4, 6, 8 },                         // producerCounts
+    { 1, 1, 1, 1, 1 },                         // consumerCounts
+    1,                                         // batchSize
+    1,                                         // warmupIterations
+    12,                                        // maxIterations
+    0.02,                                      // targetConfidence
+};
+
+static BenchmarkSuiteConfig batchThroughputConfig {
+    6,                                         // iterations
+    { (size_t)1E6, (size_t)5E6, (size_t)1E7 }, // jobCounts
+    { 1, 2, 4, 6, 8 },                         // producerCounts
+    { 1, 2, 4, 6, 8 },                         // consumerCounts
+    32,                                        // batchSize
+    1,                                         // warmupIterations
+    12,                                        // maxIterations
+    0.02,                                      // targetConfidence
+};
+
+// Ring capacities from 4 cells up to 1M, past where the ring outgrows the caches and the TLB reach of 4K pages
+static BenchmarkSuiteConfig capacitySweepConfig {
+    6,                                         // iterations
+    { (size_t)1E7 },                           // jobCounts
+    { 1, 2, 4, 8 },                            // producerCounts
+    { 1, 2, 4, 8 },                            // consumerCounts
+    1,                                         // batchSize
+    1,                                         // warmupIterations
+    12,                                        // maxIterations
+    0.02,                                      // targetConfidence
+    { 4, 16, 64, 256, 1 << 10, 1 << 12, 1 << 14, 1 << 16, 1 << 18, 1 << 20 }, // capacities
+};
+
+// Offered loads from light to well past what the default jobs let a few consumers keep up with, so each queue's
+// latency stays flat and then climbs once it saturates
+static BenchmarkSuiteConfig offeredLoadConfig {
+    3,                                         // iterations
+    { (size_t)1E5 },                           // jobCounts
+    { 1, 4 },                                  // producerCounts
+    { 1, 4 },                                  // consumerCounts
+    1,                                         // batchSize
+    0,                                         // warmupIterations, each iteration runs at least jobs / load seconds
+    0,                                         // maxIterations
+    0.02,                                      // targetConfidence
+    {},                                        // capacities
+    ArrivalPattern::Poisson,                   // arrivalPattern
+    { 1E4, 2E4, 5E4, 1E5, 2E5, 5E5, 1E6 },     // offeredLoads
+};
+
+// What a suite measures, each writes its own CSV columns (see main.cpp)
+enum class BenchmarkType {
+    Throughput,
+    Latency,
+    Reclamation, // throughput plus how many retired nodes were waiting to be freed, needs queues with a Reclaimer
+    Load,        // latency with producers offering each of offeredLoads in turn (open loop) instead of saturating
+};
+
+// One sweep: every queue is run for every job count and producer/consumer pair in config, and the results for each job
+// count are written to outputBasePath + "_job_count_<count>.csv". Suites can also be loaded from a JSON file or
+// adjusted from the command line (run queues --help).
+struct BenchmarkSuite {
+    std::string name;
+    BenchmarkType type;
+    std::vector<std::string> queues; // ids registered in main.cpp's registerQueues, see --list
+    BenchmarkSuiteConfig config;
+    std::string jobPool = "default";
+    std::string outputBasePath;
+    bool enabledByDefault = false; // run when no suites are selected on the command line
+};
+
+// Built-in suites, used when no --config file is given. Only throughput and latency run by default, select the others
+// with --suite.
+static std::vector<BenchmarkSuite> defaultSuites() {
+    const std::vector<std::string> allQueues {
+        "linked_list", "circular_buffer_4", "circular_buffer_16", "scq_16", "spsc_ring_16", "intrusive_mpsc", "moodycamel",
+        "std_queue_blocking", "flat_combining", "work_stealing_intrusive_mpsc", "work_stealing_moodycamel",
+    };
+    const std::vector<std::string> sharedQueues {
+        "linked_list", "circular_buffer_4", "circular_buffer_16", "scq_16", "spsc_ring_16", "intrusive_mpsc", "moodycamel",
+        "std_queue_blocking", "flat_combining",
+    };
+    const std::vector<std::string> waitStrategyQueues {
+        "circular_buffer_16_spin", "circular_buffer_16_backoff", "circular_buffer_16_yield", "circular_buffer_16_park",
+        "moodycamel_spin", "moodycamel_backoff", "moodycamel_yield", "moodycamel_park",
+    };
+
+    return {
+        { "throughput", BenchmarkType::Throughput, allQueues, defaultThroughputConfig, "default",
+          "../reporting/results/throughput/throughput", true },
+        { "latency", BenchmarkType::Latency, sharedQueues, defaultLatencyConfig, "default",
+          "../reporting/results/latency/latency", true },
+        { "wait_strategy_throughput", BenchmarkType::Throughput, waitStrategyQueues, defaultThroughputConfig, "default",
+          "../reporting/results/throughput_wait_strategy/throughput" },
+        { "wait_strategy_latency", BenchmarkType::Latency, waitStrategyQueues, defaultLatencyConfig, "default",
+          "../reporting/results/latency_wait_strategy/latency" },
+        { "completion_overhead", BenchmarkType::Throughput,
+          { "linked_list_shared_completion", "linked_list_per_consumer_completion",
+            "circular_buffer_16_shared_completion", "circular_buffer_16_per_consumer_completion",
+            "moodycamel_shared_completion", "moodycamel_per_consumer_completion",
+            "std_queue_blocking_shared_completion", "std_queue_blocking_per_consumer_completion" },
+          defaultThroughputConfig, "default", "../reporting/results/throughput_completion/throughput" },
+        { "one_consumer_throughput", BenchmarkType::Throughput,
+          { "linked_list", "circular_buffer_16", "intrusive_mpsc", "moodycamel", "std_queue_blocking" },
+          oneConsumerThroughputConfig, "default", "../reporting/results/throughput_one_consumer/throughput" },
+        { "batch_throughput", BenchmarkType::Throughput, sharedQueues, batchThroughputConfig, "default",
+          "../reporting/results/throughput_batch/throughput" },
+        { "reclamation", BenchmarkType::Reclamation, { "linked_list_immediate", "linked_list", "linked_list_epoch" },
+          defaultThroughputConfig, "default", "../reporting/results/reclamation/reclamation" },
+        // bounded queues waiting for room vs dropping what doesn't fit, next to unbounded queues for reference
+        { "backpressure_throughput", BenchmarkType::Throughput,
+          { "circular_buffer_4", "circular_buffer_4_drop", "circular_buffer_16", "circular_buffer_16_drop",
+            "spsc_ring_16", "spsc_ring_16_drop", "linked_list", "moodycamel" },
+          defaultThroughputConfig, "default", "../reporting/results/throughput_backpressure/throughput" },
+        // static vs virtual dispatch of every queue operation, with no-op jobs so the call overhead isn't hidden by job work.
+        // IQueue has no tokens, so queues that have them are compared without them on both sides
+        { "dispatch_throughput", BenchmarkType::Throughput,
+          { "linked_list_no_tokens", "linked_list_virtual", "circular_buffer_4", "circular_buffer_4_virtual",
+            "circular_buffer_16", "circular_buffer_16_virtual", "scq_16", "scq_16_virtual", "spsc_ring_16", "spsc_ring_16_virtual",
+            "intrusive_mpsc", "intrusive_mpsc_virtual", "moodycamel_no_tokens", "moodycamel_virtual",
+            "std_queue_blocking", "std_queue_blocking_virtual" },
+          defaultThroughputConfig, "noop", "../reporting/results/throughput_dispatch/throughput" },
+        // runtime sized ring on normal pages vs huge pages, swept over capacitySweepConfig's capacities
+        { "capacity_throughput", BenchmarkType::Throughput,
+          { "circular_buffer_runtime", "circular_buffer_runtime_huge" },
+          capacitySweepConfig, "default", "../reporting/results/throughput_capacity/throughput" },
+        // packed vs padded vs swizzled cells, in a small ring where every thread works on neighbouring cells and in a
+        // 1024 cell one
+        { "cell_layout_throughput", BenchmarkType::Throughput,
+          { "circular_buffer_16", "circular_buffer_16_padded", "circular_buffer_16_swizzled",
+            "circular_buffer_runtime", "circular_buffer_runtime_padded", "circular_buffer_runtime_swizzled" },
+          defaultThroughputConfig, "default", "../reporting/results/throughput_cell_layout/throughput" },
+        // fetch_add ring positions vs CAS loops on the ring/list ends, as producers and consumers are added
+        { "contention_throughput", BenchmarkType::Throughput,
+          { "circular_buffer_16", "scq_16", "circular_buffer_runtime", "scq_1024", "linked_list", "moodycamel" },
+          defaultThroughputConfig, "default", "../reporting/results/throughput_contention/throughput" },
+        // unbounded queues: one node per job vs linked ring blocks (small blocks link new ones far more often)
+        { "unbounded_throughput", BenchmarkType::Throughput,
+          { "linked_list", "linked_list_pool", "segmented_ring", "segmented_ring_16", "segmented_ring_heap", "moodycamel" },
+          defaultThroughputConfig, "default", "../reporting/results/throughput_unbounded/throughput" },
+        { "unbounded_latency", BenchmarkType::Latency,
+          { "linked_list", "linked_list_pool", "segmented_ring", "segmented_ring_16", "segmented_ring_heap", "moodycamel" },
+          defaultLatencyConfig, "default", "../reporting/results/latency_unbounded/latency" },
+        // std::mutex vs spin, ticket and MCS locks, around one std::queue and in the two-lock queue
+        { "lock_throughput", BenchmarkType::Throughput,
+          { "std_queue_blocking", "std_queue_blocking_ttas", "std_queue_blocking_ticket", "std_queue_blocking_mcs",
+            "two_lock", "two_lock_ttas", "two_lock_ticket", "two_lock_mcs", "flat_combining" },
+          defaultThroughputConfig, "default", "../reporting/results/throughput_lock/throughput" },
+        // queues with per-thread tokens, with and without them
+        { "token_throughput", BenchmarkType::Throughput,
+          { "moodycamel", "moodycamel_no_tokens", "flat_combining", "flat_combining_no_tokens",
+            "segmented_ring", "segmented_ring_no_tokens", "linked_list", "linked_list_no_tokens" },
+          defaultThroughputConfig, "default", "../reporting/results/throughput_token/throughput" },
+        // latency vs offered load, the knee is where each queue stops keeping up
+        { "load_latency", BenchmarkType::Load,
+          { "linked_list", "circular_buffer_16", "scq_16", "moodycamel", "std_queue_blocking" },
+          offeredLoadConfig, "default", "../reporting/results/load_latency/load" },
+        { "node_allocator", BenchmarkType::Throughput,
+          { "linked_list", "linked_list_pool", "linked_list_epoch", "linked_list_epoch_pool" },
+          defaultThroughputConfig, "default", "../reporting/results/throughput_node_allocator/throughput" },
+    };
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+#include "SuiteFile.h"
+#include "../Config.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+struct CommandLineOptions {
+    bool help = false;
+    bool list = false;
+    std::string configPath;
+
+    // suites to run by name, the ones enabled by default if empty
+    std::vector<std::string> suites;
+    bool allSuites = false;
+
+    // builds a one-off suite instead of selecting existing ones
+    std::optional<BenchmarkType> type;
+
+    // override the selected suites
+    std::vector<std::string> queues;
+    std::optional<int> iterations;
+    std::optional<int> warmupIterations;
+    std::optional<int> maxIterations;
+    std::optional<double> targetConfidence;
+    std::vector<size_t> jobCounts;
+    std::vector<int> producerCounts;
+    std::vector<int> consumerCounts;
+    std::optional<size_t> batchSize;
+    std::vector<size_t> capacities;
+    std::optional<ArrivalPattern> arrival;
+    std::vector<double> offeredLoads;
+    std::optional<std::string> jobPool;
+    std::optional<std::string> output;
+};
+
+// Parses the benchmark's command line and applies it to the available suites. Throws std::runtime_error on bad input.
+class CommandLine {
+public:
+    static void PrintUsage(std::ostream& out) {
+        out << "Usage: queues [options]\n"
+               "\n"
+               "Suites:\n"
+               "  --config FILE          load suites from a JSON file instead of the built-in ones (see configs/)\n"
+               "  --suite NAME[,NAME]    run these suites, by default only the ones enabled by default\n"
+               "  --all                  run every suite\n"
+               "  --type TYPE            run a one-off suite of this type (throughput, latency, reclamation, load), needs --queues\n"
+               "  --list                 print the suites, queues and job pools, then exit\n"
+               "\n"
+               "Overrides for the selected suites:\n"
+               "  --queues ID[,ID]       queue ids to benchmark\n"
+               "  --iterations N\n"
+               "  --warmup N             unmeasured iterations before each configuration's measured ones\n"
+               "  --max-iterations N     keep adding iterations up to N until the 95% confidence interval is narrow enough, 0 never does\n"
+               "  --target-ci F          confidence interval half width to stop at, as a fraction of the mean (e.g. 0.02)\n"
+               "  --job-counts N[,N]     accepts scientific notation, e.g. 1e6\n"
+               "  --producers N[,N]      producer count of each run, paired with --consumers\n"
+               "  --consumers N[,N]\n"
+               "  --batch-size N\n"
+               "  --capacities N[,N]     capacities to run queues with a runtime capacity at, rounded up to powers of two\n"
+               "  --arrival PATTERN      how producers of load suites space out jobs (constant, poisson, bursty)\n"
+               "  --offered-loads N[,N]  total jobs/sec load suites offer the queue, one run each\n"
+               "  --job-pool NAME\n"
+               "  --output PATH          CSV base path, only when a single suite is selected\n"
+               "  --help\n";
+    }
+
+    static CommandLineOptions Parse(int argc, char** argv) {
+        CommandLineOptions options;
+        for (int i = 1; i < argc; i++) {
+            std::string flag = argv[i];
+            std::string value;
+            bool hasInlineValue = false;
+            size_t equals = flag.find('=');
+            if (flag.rfind("--", 0) == 0 && equals != std::string::npos) {
+                value = flag.substr(equals + 1);
+                flag = flag.substr(0, equals);
+                hasInlineValue = true;
+            }
+            auto next = [&]() -> std::string {
+                if (hasInlineValue) return value;
+                if (i + 1 >= argc) throw std::runtime_error(flag + " needs a value");
+                return argv[++i];
+            };
+
+            if (flag == "--help" || flag == "-h") options.help = true;
+            else if (flag == "--list") options.list = true;
+            else if (flag == "--all") options.allSuites = true;
+            else if (flag == "--config") options.configPath = next();
+            else if (flag == "--suite") appendList(options.suites, next());
+            else if (flag == "--type") options.type = SuiteFile::ParseType(next());
+            else if (flag == "--queues") appendList(options.queues, next());
+            else if (flag == "--iterations") options.iterations = parseWholePositive<int>(flag, next());
+            else if (flag == "--warmup") options.warmupIterations = parseWholeNonNegative<int>(flag, next());
+            else if (flag == "--max-iterations") options.maxIterations = parseWholeNonNegative<int>(flag, next());
+            else if (flag == "--target-ci") options.targetConfidence = parseNonNegative(flag, next());
+            else if (flag == "--job-counts") options.jobCounts = parseNumberList<size_t>(flag, next());
+            else if (flag == "--producers") options.producerCounts = parseNumberList<int>(flag, next());
+            else if (flag == "--consumers") options.consumerCounts = parseNumberList<int>(flag, next());
+            else if (flag == "--batch-size") options.batchSize = parseWholePositive<size_t>(flag, next());
+            else if (flag == "--capacities") options.capacities = parseNumberList<size_t>(flag, next());
+            else if (flag == "--arrival") options.arrival = SuiteFile::ParseArrival(next());
+            else if (flag == "--offered-loads") options.offeredLoads = parseNumberList<double>(flag, next());
+            else if (flag == "--job-pool") options.jobPool = next();
+            else if (flag == "--output") options.output = next();
+            else throw std::runtime_error("Unknown option " + flag + ", see --help");
+        }
+        return options;
+    }
+
+    // Returns the suites to run, with the command line overrides applied
+    static std::vector<BenchmarkSuite> SelectSuites(const CommandLineOptions& options, const std::vector<BenchmarkSuite>& available) {
+        std::vector<BenchmarkSuite> selected;
+        if (options.type) {
+            if (!options.suites.empty() || options.allSuites) throw std::runtime_error("--type can't be combined with --suite or --all");
+            if (options.queues.empty()) throw std::runtime_error("--type needs --queues");
+
+            BenchmarkSuite suite;
+            suite.name = "custom";
+            suite.type = *options.type;
+            suite.config = SuiteFile::DefaultConfig(suite.type);
+            suite.outputBasePath = std::string("../reporting/results/custom/") + SuiteFile::TypeName(suite.type);
+            selected.push_back(suite);
+        } else if (options.allSuites) {
+            selected = available;
+        } else if (!options.suites.empty()) {
+            for (const std::string& name : options.suites) {
+                const BenchmarkSuite* suite = nullptr;
+                for (const auto& candidate : available) {
+                    if (candidate.name == name) suite = &candidate;
+                }
+                if (suite == nullptr) throw std::runtime_error("Unknown suite '" + name + "', see --list");
+                selected.push_back(*suite);
+            }
+        } else {
+            for (const auto& suite : available) {
+                if (suite.enabledByDefault) selected.push_back(suite);
+            }
+        }
+
+        if (options.output && selected.size() != 1) throw std::runtime_error("--output needs exactly one selected suite");
+
+        for (BenchmarkSuite& suite : selected) {
+            if (!options.queues.empty()) suite.queues = options.queues;
+            if (options.iterations) suite.config.iterations = *options.iterations;
+            if (options.warmupIterations) suite.config.warmupIterations = *options.warmupIterations;
+            if (options.maxIterations) suite.config.maxIterations = *options.maxIterations;
+            if (options.targetConfidence) suite.config.targetConfidence = *options.targetConfidence;
+            if (!options.jobCounts.empty()) suite.config.jobCounts = options.jobCounts;
+            if (!options.producerCounts.empty()) suite.config.producerCounts = options.producerCounts;
+            if (!options.consumerCounts.empty()) suite.config.consumerCounts = options.consumerCounts;
+            if (options.batchSize) suite.config.batchSize = *options.batchSize;
+            if (!options.capacities.empty()) suite.config.capacities = options.capacities;
+            if (options.arrival) suite.config.arrivalPattern = *options.arrival;
+            if (!options.offeredLoads.empty()) suite.config.offeredLoads = options.offeredLoads;
+            if (options.jobPool) suite.jobPool = *options.jobPool;
+            if (options.output) suite.outputBasePath = *options.output;
+
+            if (suite.config.producerCounts.size() != suite.config.consumerCounts.size()) {
+                throw std::runtime_error("Suite '" + suite.name + "' has " + std::to_string(suite.config.producerCounts.size()) +
+                                         " producer counts but " + std::to_string(suite.config.consumerCounts.size()) +
+                                         " consumer counts, pass both --producers and --consumers");
+            }
+        }
+        return selected;
+    }
+
+private:
+    static void appendList(std::vector<std::string>& dest, const std::string& list) {
+        std::stringstream stream(list);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            if (!item.empty()) dest.push_back(item);
+        }
+    }
+
+    static double parsePositive(const std::string& flag, const std::string& text) {
+        char* end = nullptr;
+        double value = std::strtod(text.c_str(), &end);
+        if (end == text.c_str() || *end != '\0' || value < 1) {
+            throw std::runtime_error(flag + " expects numbers >= 1, got '" + text + "'");
+        }
+        return value;
+    }
+
+    static double parseNonNegative(const std::string& flag, const std::string& text) {
+        char* end = nullptr;
+        double value = std::strtod(text.c_str(), &end);
+        if (end == text.c_str() || *end != '\0' || value < 0) {
+            throw std::runtime_error(flag + " expects a number >= 0, got '" + text + "'");
+        }
+        return value;
+    }
+
+    // Options that count something reject fractions and values T can't hold instead of truncating them
+    template<typename T>
+    static T requireWhole(const std::string& flag, const std::string& text, double value) {
+        if (value != std::floor(value) || value >= std::ldexp(1.0, std::numeric_limits<T>::digits)) {
+            throw std::runtime_error(flag + " expects whole numbers, got '" + text + "'");
+        }
+        return (T)value;
+    }
+
+    template<typename T>
+    static T parseWholePositive(const std::string& flag, const std::string& text) {
+        return requireWhole<T>(flag, text, parsePositive(flag, text));
+    }
+
+    template<typename T>
+    static T parseWholeNonNegative(const std::string& flag, const std::string& text) {
+        return requireWhole<T>(flag, text, parseNonNegative(flag, text));
+    }
+
+    template<typename T>
+    static std::vector<T> parseNumberList(const std::string& flag, const std::string& list) {
+        std::vector<std::string> items;
+        appendList(items, list);
+        if (items.empty()) throw std::runtime_error(flag + " needs at least one value");
+
+        std::vector<T> result;
+        for (const std::string& item : items) {
+            if constexpr (std::is_integral_v<T>) result.push_back(parseWholePositive<T>(flag, item));
+            else result.push_back((T)parsePositive(flag, item));
+        }
+        return result;
+    }
+};
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal JSON document, enough for benchmark configuration files
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object; // in file order
+
+    bool IsNull() const { return type == Type::Null; }
+    bool IsBool() const { return type == Type::Bool; }
+    bool IsNumber() const { return type == Type::Number; }
+    bool IsString() const { return type == Type::String; }
+    bool IsArray() const { return type == Type::Array; }
+    bool IsObject() const { return type == Type::Object; }
+
+    // Returns the member called key, or nullptr if this isn't an object or has no such member
+    const JsonValue* Find(const std::string& key) const {
+        for (const auto& member : object) {
+            if (member.first == key) return &member.second;
+        }
+        return nullptr;
+    }
+};
+
+// Recursive descent parser, throws std::runtime_error with the offset of the first error
+class JsonParser {
+public:
+    static JsonValue Parse(const std::string& text) {
+        JsonParser parser(text);
+        parser.skipWhitespace();
+        JsonValue value = parser.parseValue();
+        parser.skipWhitespace();
+        if (parser.pos != text.size()) parser.fail("unexpected trailing characters");
+        return value;
+    }
+
+private:
+    explicit JsonParser(const std::string& text) : text(text) { }
+
+    JsonValue parseValue() {
+        if (pos >= text.size()) fail("unexpected end of input");
+        switch (text[pos]) {
+            case '{': return parseObject();
+            case '[': return parseArray();
+            case '"': {
+                JsonValue value;
+                value.type = JsonValue::Type::String;
+                value.string = parseString();
+                return value;
+            }
+            case 't': return parseLiteral("true", JsonValue::Type::Bool, true);
+            case 'f': return parseLiteral("false", JsonValue::Type::Bool, false);
+            case 'n': return parseLiteral("null", JsonValue::Type::Null, false);
+            default: return parseNumber();
+        }
+    }
+
+    JsonValue parseObject() {
+        JsonValue value;
+        value.type = JsonValue::Type::Object;
+        expect('{');
+        skipWhitespace();
+        if (consume('}')) return value;
+        while (true) {
+            skipWhitespace();
+            if (pos >= text.size() || text[pos] != '"') fail("expected a member name");
+            std::string key = parseString();
+            skipWhitespace();
+            expect(':');
+            skipWhitespace();
+            value.object.emplace_back(std::move(key), parseValue());
+            skipWhitespace();
+            if (consume('}')) return value;
+            expect(',');
+        }
+    }
+
+    JsonValue parseArray() {
+        JsonValue value;
+        value.type = JsonValue::Type::Array;
+        expect('[');
+        skipWhitespace();
+        if (consume(']')) return value;
+        while (true) {
+            skipWhitespace();
+            value.array.push_back(parseValue());
+            skipWhitespace();
+            if (consume(']')) return value;
+            expect(',');
+        }
+    }
+
+    std::string parseString() {
+        expect('"');
+        std::string result;
+        while (true) {
+            if (pos >= text.size()) fail("unterminated string");
+            char c = text[pos++];
+            if (c == '"') return result;
+            if (c != '\\') {
+                result += c;
+                continue;
+            }
+            if (pos >= text.size()) fail("unterminated string");
+            char escaped = text[pos++];
+            switch (escaped) {
+                case '"': result += '"'; break;
+                case '\\': result += '\\'; break;
+                case '/': result += '/'; break;
+                case 'b': result += '\b'; break;
+                case 'f': result += '\f'; break;
+                case 'n': result += '\n'; break;
+                case 'r': result += '\r'; break;
+                case 't': result += '\t'; break;
+                case 'u': {
+                    if (pos + 4 > text.size()) fail("bad \\u escape");
+                    for (size_t i = pos; i < pos + 4; i++) {
+                        if (!std::isxdigit((unsigned char)text[i])) fail("\\u escape needs four hex digits");
+                    }
+                    unsigned long code = std::strtoul(text.substr(pos, 4).c_str(), nullptr, 16);
+                    pos += 4;
+                    // configuration files are ASCII, anything else (and NUL, which would cut names short) is kept as a placeholder
+                    result += code > 0 && code < 0x80 ? (char)code : '?';
+                    break;
+                }
+                default: fail("bad escape character");
+            }
+        }
+    }
+
+    JsonValue parseNumber() {
+        const char* start = text.c_str() + pos;
+        char* end = nullptr;
+        double number = std::strtod(start, &end);
+        if (end == start) fail("unexpected character");
+        pos += end - start;
+
+        JsonValue value;
+        value.type = JsonValue::Type::Number;
+        value.number = number;
+        return value;
+    }
+
+    JsonValue parseLiteral(const std::string& literal, JsonValue::Type type, bool boolean) {
+        if (text.compare(pos, literal.size(), literal) != 0) fail("unexpected character");
+        pos += literal.size();
+
+        JsonValue value;
+        value.type = type;
+        value.boolean = boolean;
+        return value;
+    }
+
+    void skipWhitespace() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) {
+            pos++;
+        }
+    }
+
+    bool consume(char c) {
+        if (pos < text.size() && text[pos] == c) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) fail(std::string("expected '") + c + "'");
+    }
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::runtime_error("JSON error at offset " + std::to_string(pos) + ": " + message);
+    }
+
+    const std::string& text;
+    size_t pos = 0;
+};
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "Json.h"
+#include "../Config.h"
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Loads benchmark suites from a JSON file shaped like configs/example.json:
+//   { "suites": [ { "name": "...", "type": "throughput" | "latency" | "reclamation" | "load", "queues": ["..."],
+//                   "iterations": 6, "jobCounts": [1e6], "producerCounts": [1, 2], "consumerCounts": [1, 2],
+//                   "batchSize": 1, "capacities": [16, 1024], "jobPool": "default", "output": "...", "enabled": true,
+//                   "arrival": "constant" | "poisson" | "bursty", "offeredLoads": [1e4, 1e5],
+//                   "warmupIterations": 1, "maxIterations": 12, "targetConfidence": 0.02 } ] }
+// Only name, type, queues and output are required, the rest default to the built-in config for the type.
+// Throws std::runtime_error describing the first problem found.
+class SuiteFile {
+public:
+    static BenchmarkType ParseType(const std::string& type) {
+        if (type == "throughput") return BenchmarkType::Throughput;
+        if (type == "latency") return BenchmarkType::Latency;
+        if (type == "reclamation") return BenchmarkType::Reclamation;
+        if (type == "load") return BenchmarkType::Load;
+        throw std::runtime_error("Unknown benchmark type '" + type + "', expected throughput, latency, reclamation or load");
+    }
+
+    static const char* TypeName(BenchmarkType type) {
+        switch (type) {
+            case BenchmarkType::Throughput: return "throughput";
+            case BenchmarkType::Latency: return "latency";
+            case BenchmarkType::Reclamation: return "reclamation";
+            case BenchmarkType::Load: return "load";
+        }
+        return "unknown";
+    }
+
+    // Saturate isn't accepted, load suites always offer a set rate
+    static ArrivalPattern ParseArrival(const std::string& arrival) {
+        if (arrival == "constant") return ArrivalPattern::Constant;
+        if (arrival == "poisson") return ArrivalPattern::Poisson;
+        if (arrival == "bursty") return ArrivalPattern::Bursty;
+        throw std::runtime_error("Unknown arrival pattern '" + arrival + "', expected constant, poisson or bursty");
+    }
+
+    static const char* ArrivalName(ArrivalPattern arrival) {
+        switch (arrival) {
+            case ArrivalPattern::Saturate: return "saturate";
+            case ArrivalPattern::Constant: return "constant";
+            case ArrivalPattern::Poisson: return "poisson";
+            case ArrivalPattern::Bursty: return "bursty";
+        }
+        return "unknown";
+    }
+
+    // Built-in sweep a suite of this type starts from
+    static const BenchmarkSuiteConfig& DefaultConfig(BenchmarkType type) {
+        if (type == BenchmarkType::Load) return offeredLoadConfig;
+        return type == BenchmarkType::Latency ? defaultLatencyConfig : defaultThroughputConfig;
+    }
+
+    static std::vector<BenchmarkSuite> Load(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) throw std::runtime_error("Could not open config file " + path);
+        std::stringstream contents;
+        contents << file.rdbuf();
+
+        JsonValue root;
+        try {
+            root = JsonParser::Parse(contents.str());
+        } catch (const std::runtime_error& e) {
+            throw std::runtime_error(path + ": " + e.what());
+        }
+
+        const JsonValue* suites = root.Find("suites");
+        if (suites == nullptr || !suites->IsArray()) throw std::runtime_error(path + ": expected a \"suites\" array");
+
+        std::vector<BenchmarkSuite> result;
+        for (const JsonValue& entry : suites->array) {
+            result.push_back(parseSuite(entry, path));
+        }
+        return result;
+    }
+
+private:
+    static BenchmarkSuite parseSuite(const JsonValue& entry, const std::string& path) {
+        if (!entry.IsObject()) throw std::runtime_error(path + ": every suite must be an object");
+
+        BenchmarkSuite suite;
+        suite.name = requireString(entry, "name", path);
+        std::string where = path + ": suite '" + suite.name + "'";
+
+        suite.type = ParseType(requireString(entry, "type", where));
+        suite.config = DefaultConfig(suite.type);
+        suite.outputBasePath = requireString(entry, "output", where);
+        suite.enabledByDefault = true;
+
+        const JsonValue* queues = entry.Find("queues");
+        if (queues == nullptr || !queues->IsArray() || queues->array.empty()) {
+            throw std::runtime_error(where + ": \"queues\" must be a non-empty array of queue ids");
+        }
+        for (const JsonValue& queue : queues->array) {
+            if (!queue.IsString()) throw std::runtime_error(where + ": queue ids must be strings");
+            suite.queues.push_back(queue.string);
+        }
+
+        if (const JsonValue* value = entry.Find("iterations")) suite.config.iterations = requireWholePositive<int>(*value, "iterations", where);
+        if (const JsonValue* value = entry.Find("jobCounts")) suite.config.jobCounts = numberList<size_t>(*value, "jobCounts", where);
+        if (const JsonValue* value = entry.Find("producerCounts")) suite.config.producerCounts = numberList<int>(*value, "producerCounts", where);
+        if (const JsonValue* value = entry.Find("consumerCounts")) suite.config.consumerCounts = numberList<int>(*value, "consumerCounts", where);
+        if (const JsonValue* value = entry.Find("batchSize")) suite.config.batchSize = requireWholePositive<size_t>(*value, "batchSize", where);
+        if (const JsonValue* value = entry.Find("capacities")) suite.config.capacities = numberList<size_t>(*value, "capacities", where);
+        if (const JsonValue* value = entry.Find("warmupIterations")) suite.config.warmupIterations = requireWholeNonNegative<int>(*value, "warmupIterations", where);
+        if (const JsonValue* value = entry.Find("maxIterations")) suite.config.maxIterations = requireWholeNonNegative<int>(*value, "maxIterations", where);
+        if (const JsonValue* value = entry.Find("targetConfidence")) suite.config.targetConfidence = requireNonNegative(*value, "targetConfidence", where);
+        if (const JsonValue* value = entry.Find("arrival")) {
+            if (!value->IsString()) throw std::runtime_error(where + ": \"arrival\" must be a string");
+            suite.config.arrivalPattern = ParseArrival(value->string);
+        }
+        if (const JsonValue* value = entry.Find("offeredLoads")) suite.config.offeredLoads = numberList<double>(*value, "offeredLoads", where);
+        if (const JsonValue* value = entry.Find("jobPool")) {
+            if (!value->IsString()) throw std::runtime_error(where + ": \"jobPool\" must be a string");
+            suite.jobPool = value->string;
+        }
+        if (const JsonValue* value = entry.Find("enabled")) {
+            if (!value->IsBool()) throw std::runtime_error(where + ": \"enabled\" must be true or false");
+            suite.enabledByDefault = value->boolean;
+        }
+
+        if (suite.config.producerCounts.size() != suite.config.consumerCounts.size()) {
+            throw std::runtime_error(where + ": producerCounts and consumerCounts must have the same length");
+        }
+        return suite;
+    }
+
+    static std::string requireString(const JsonValue& object, const std::string& key, const std::string& where) {
+        const JsonValue* value = object.Find(key);
+        if (value == nullptr || !value->IsString()) throw std::runtime_error(where + ": \"" + key + "\" must be a string");
+        return value->string;
+    }
+
+    static double requirePositive(const JsonValue& value, const std::string& key, const std::string& where) {
+        if (!value.IsNumber() || value.number < 1) throw std::runtime_error(where + ": \"" + key + "\" must be a number >= 1");
+        return value.number;
+    }
+
+    static double requireNonNegative(const JsonValue& value, const std::string& key, const std::string& where) {
+        if (!value.IsNumber() || value.number < 0) throw std::runtime_error(where + ": \"" + key + "\" must be a number >= 0");
+        return value.number;
+    }
+
+    // Keys that count something reject fractions and values T can't hold instead of truncating them
+    template<typename T>
+    static T requireWhole(double number, const std::string& key, const std::string& where) {
+        if (number != std::floor(number) || number >= std::ldexp(1.0, std::numeric_limits<T>::digits)) {
+            throw std::runtime_error(where + ": \"" + key + "\" must be a whole number");
+        }
+        return (T)number;
+    }
+
+    template<typename T>
+    static T requireWholePositive(const JsonValue& value, const std::string& key, const std::string& where) {
+        return requireWhole<T>(requirePositive(value, key, where), key, where);
+    }
+
+    template<typename T>
+    static T requireWholeNonNegative(const JsonValue& value, const std::string& key, const std::string& where) {
+        return requireWhole<T>(requireNonNegative(value, key, where), key, where);
+    }
+
+    template<typename T>
+    static std::vector<T> numberList(const JsonValue& value, const std::string& key, const std::string& where) {
+        if (!value.IsArray() || value.array.empty()) throw std::runtime_error(where + ": \"" + key + "\" must be a non-empty array");
+        std::vector<T> result;
+        for (const JsonValue& element : value.array) {
+            if constexpr (std::is_integral_v<T>) result.push_back(requireWholePositive<T>(element, key, where));
+            else result.push_back((T)requirePositive(element, key, where));
+        }
+        return result;
+    }
+};
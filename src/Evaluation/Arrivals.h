@@ -0,0 +1,86 @@
+#pragma once
+
+#include "TscClock.h"
+#include "Wait/CpuRelax.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <thread>
+
+// How producers space out their enqueues
+enum class ArrivalPattern {
+    Saturate, // enqueue as fast as the queue takes jobs (closed loop), how every benchmark ran before
+    Constant, // evenly spaced at the target rate
+    Poisson,  // exponentially distributed gaps averaging the target rate, like independent clients
+    Bursty,   // on/off: each period's jobs arrive at 1/dutyCycle times the target rate, then nothing until the next one
+};
+
+// The load offered to the queue: all producers together aim for jobsPerSecond, each producer taking an equal share.
+// Saturate ignores jobsPerSecond.
+struct ArrivalRate {
+    ArrivalPattern pattern = ArrivalPattern::Saturate;
+    double jobsPerSecond = 0;
+
+    [[nodiscard]] bool IsOpenLoop() const { return pattern != ArrivalPattern::Saturate && jobsPerSecond > 0; }
+};
+
+// One producer's arrival times. The schedule is open loop: it never waits for the queue, so a producer that fell behind
+// (the queue pushed back, or it was descheduled) enqueues straight away until it has caught up instead of offering less
+// load.
+class ArrivalSchedule {
+public:
+    // Length of one bursty on/off period, and the part of it jobs arrive in
+    static constexpr double burstPeriodNs = 1e6;
+    static constexpr double dutyCycle = 0.2;
+
+    // start is shared by every producer of the run, so constant arrivals of different producers interleave evenly and
+    // bursts line up
+    ArrivalSchedule(ArrivalRate rate, int numProducers, int producerIndex, TscClock::time_point start)
+        : pattern(rate.pattern), start(start), rng(0x9E3779B97F4A7C15ull * (producerIndex + 1)) {
+        if (!rate.IsOpenLoop()) return;
+        meanGapNs = 1e9 * numProducers / rate.jobsPerSecond;
+        gaps = std::exponential_distribution<double>(1.0 / meanGapNs);
+        if (pattern == ArrivalPattern::Constant) offsetNs = meanGapNs * producerIndex / numProducers;
+    }
+
+    [[nodiscard]] bool IsOpenLoop() const { return meanGapNs > 0; }
+
+    // Waits for the next job's arrival and returns when it was due, or returns early once running is false
+    TscClock::time_point WaitForNext(const std::atomic<bool>& running) {
+        offsetNs += pattern == ArrivalPattern::Poisson ? gaps(rng) : meanGapNs;
+        auto due = start + TscClock::duration((TscClock::rep)arrivalNs(offsetNs));
+        waitUntil(due, running);
+        return due;
+    }
+
+private:
+    // Sleeping overshoots by tens of microseconds, so the last stretch before an arrival is spun
+    static constexpr auto spinThreshold = std::chrono::microseconds(100);
+
+    // Maps a position on the evenly spaced schedule to the time it arrives. Bursty squeezes every period's jobs into
+    // its first dutyCycle.
+    [[nodiscard]] double arrivalNs(double offset) const {
+        if (pattern != ArrivalPattern::Bursty) return offset;
+        double period = std::floor(offset / burstPeriodNs);
+        return period * burstPeriodNs + (offset - period * burstPeriodNs) * dutyCycle;
+    }
+
+    static void waitUntil(TscClock::time_point due, const std::atomic<bool>& running) {
+        while (running.load(std::memory_order_relaxed)) {
+            auto remaining = due - TscClock::now();
+            if (remaining <= TscClock::duration::zero()) return;
+            if (remaining > spinThreshold) std::this_thread::sleep_for(remaining - spinThreshold);
+            else cpuRelax();
+        }
+    }
+
+    ArrivalPattern pattern;
+    TscClock::time_point start;
+    double meanGapNs = 0;
+    double offsetNs = 0;
+    std::mt19937_64 rng;
+    std::exponential_distribution<double> gaps;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Job.h>
+
+#include "QueueTraits.h"
+#include "QueueHandle.h"
+#include "Wait/CpuRelax.h"
+
+#include <atomic>
+#include <cstddef>
+
+// What a producer does when a bounded queue is full
+enum class FullQueuePolicy {
+    Block, // wait for room, so the queue pushes back on the producer and every job is delivered
+    Drop,  // drop whatever doesn't fit, how bounded queues used to behave
+};
+
+// Counted by each producer and summed into ThroughputResult
+struct EnqueueStats {
+    size_t fullEnqueues = 0; // enqueue calls that found the queue full
+    size_t dropped = 0;      // jobs dropped under FullQueuePolicy::Drop
+};
+
+// Enqueues count jobs through the producer's handle, handling a full bounded queue according to policy. Queues without
+// TryEnqueue are unbounded and are enqueued into directly. Returns the number of jobs enqueued, fewer than count if some
+// were dropped or running turned false while waiting for room.
+template<FullQueuePolicy policy, typename QueueT, bool useTokens>
+size_t enqueueJobs(ProducerHandle<QueueT, useTokens>& producer, Job* const* jobs, size_t count, const std::atomic<bool>& running, EnqueueStats& stats) {
+    if (count == 0) return 0;
+    if constexpr (!QueueHasTryEnqueue<QueueT>::value) {
+        if (count == 1) producer.Enqueue(jobs[0]);
+        else producer.EnqueueBulk(jobs, count);
+        return count;
+    } else {
+        QueueT& queue = producer.Queue();
+        size_t enqueued = count == 1 ? (queue.TryEnqueue(jobs[0]) ? 1 : 0) : queue.TryEnqueueBulk(jobs, count);
+        if (enqueued == count) return count;
+
+        stats.fullEnqueues++;
+        if constexpr (policy == FullQueuePolicy::Drop) {
+            stats.dropped += count - enqueued;
+        } else if constexpr (QueueHasEnqueueWhile<QueueT>::value) {
+            size_t remaining = count - enqueued;
+            if (remaining == 1) enqueued += queue.EnqueueWhile(jobs[enqueued], running) ? 1 : 0;
+            else enqueued += queue.EnqueueBulkWhile(jobs + enqueued, remaining, running);
+        } else {
+            // the queue can't wait for room itself, so retry until there is
+            while (enqueued < count && running.load(std::memory_order_relaxed)) {
+                size_t added = queue.TryEnqueueBulk(jobs + enqueued, count - enqueued);
+                if (added == 0) cpuRelax();
+                enqueued += added;
+            }
+        }
+        return enqueued;
+    }
+}
@@ -3,68 +3,124 @@
 #include <Job.h>
 
 #include "JobSystem.h"
+#include "WorkStealingJobSystem.h"
+#include "QueueTraits.h"
 #include "Jobs/Pools/DefaultJobPool.h"
 #include "Stopwatch.h"
+#include "TscClock.h"
+#include "CpuTime.h"
+#include "LatencyHistogram.h"
+#include "Arrivals.h"
 
 #include <string>
 #include <memory>
 #include <vector>
 #include <chrono>
+#include <map>
+
+// Fills a vector with the jobs producers cycle through, e.g. createDefaultJobPool
+using JobPoolFactory = void (*)(std::vector<std::unique_ptr<Job>>& dest);
 
 // Structures for throughput and latency outputs
 struct ThroughputResult {
     size_t numJobsCompleted;
     std::chrono::high_resolution_clock::duration elapsed;
+    size_t numSteals = 0; // only counted by the work-stealing scheduler
+    size_t numFullEnqueues = 0; // enqueue calls that found a bounded queue full, and waited or dropped
+    size_t numDropped = 0; // jobs dropped because the queue was full, only with DropWhenFull
+    std::chrono::nanoseconds cpuTime{}; // CPU time used by the process while elapsed was measured
 };
 
 struct LatencyResult {
-    std::vector<std::chrono::high_resolution_clock::duration> latencies;
+    LatencyHistogram latencies; // from enqueue to dequeue
+    LatencyHistogram correctedLatencies; // from when the job was due to dequeue, same as latencies unless open loop
+    std::chrono::high_resolution_clock::duration elapsed{};
+    std::chrono::nanoseconds cpuTime{}; // CPU time used by the process while elapsed was measured
 };
 
 template<typename QueueT>
 class Benchmark {
 public:
-    // When Benchmark is initialized, if there are no jobs, it will call createDefaultJobPool to create jobs
-    explicit Benchmark() {
+    // Returns false if QueueT can't be used safely by this many producer/consumer threads
+    static bool SupportsThreadCounts(int numProducers, int numConsumers) {
+        return numProducers <= QueueMaxProducers<QueueT>::value && numConsumers <= QueueMaxConsumers<QueueT>::value;
+    }
+
+    // When Benchmark is initialized, if there are no jobs from createJobPool yet, it will call it to create them.
+    // queueCapacity sizes queues with a runtime capacity, 0 keeps their default.
+    explicit Benchmark(JobPoolFactory createJobPool = createDefaultJobPool, size_t queueCapacity = 0)
+        : jobs(jobPools[createJobPool]), queueCapacity(queueCapacity) {
         if (jobs.empty()) {
-            createDefaultJobPool(jobs);
+            // intrusive queues can only hold each job once at a time, so they get enough copies to fill the queue
+            size_t copies = QueueIsIntrusive<QueueT>::value ? intrusiveJobPoolCopies : 1;
+            for (size_t i = 0; i < copies; i++) {
+                createJobPool(jobs);
+            }
         }
     }
 
-    // Finds the throughput of all the jobs
-    ThroughputResult RunThroughput(size_t numJobs, int numProducers, int numConsumers) {
+    // Finds the throughput of all the jobs. arrivalRate paces the producers, by default they saturate the queue.
+    ThroughputResult RunThroughput(size_t numJobs, int numProducers, int numConsumers, size_t batchSize = 1, ArrivalRate arrivalRate = {}) {
         // Initializes stopwatch object
-        Stopwatch stopwatch;
+        Stopwatch<TscClock> stopwatch;
 
         // Makes a job system
-        auto jobSystem = std::make_unique<JobSystem<QueueT, false>>(jobs);
-        jobSystem->StartWorkers(numProducers, numConsumers);
+        auto jobSystem = std::make_unique<typename JobSystemFor<QueueT, false>::type>(jobs, queueCapacity);
+        jobSystem->StartWorkers(numProducers, numConsumers, batchSize, arrivalRate);
 
+        auto cpuStart = getProcessCpuTime();
         stopwatch.Reset();
+        jobSystem->ReleaseWorkers();
         jobSystem->WaitForJobs(numJobs);
         auto elapsed = stopwatch.Tick();
+        auto cpuTime = getProcessCpuTime() - cpuStart;
 
         jobSystem->StopWorkers();
 
-        return {
+        ThroughputResult result {
             jobSystem->GetCompletedJobCount(),
             elapsed,
         };
+        result.cpuTime = cpuTime;
+        result.numFullEnqueues = jobSystem->GetFullEnqueueCount();
+        result.numDropped = jobSystem->GetDroppedCount();
+        if constexpr (IsWorkStealing<QueueT>::value) {
+            result.numSteals = jobSystem->GetStealCount();
+        }
+        return result;
     }
 
-    // Finds the latency of all jobs
-    LatencyResult RunLatency(size_t numJobs, int numProducers, int numConsumers) {
-        auto jobSystem = std::make_unique<JobSystem<QueueT, true>>(jobs);
-        jobSystem->StartWorkers(numProducers, numConsumers);
+    // Finds the latency of all jobs. arrivalRate paces the producers, by default they saturate the queue.
+    LatencyResult RunLatency(size_t numJobs, int numProducers, int numConsumers, size_t batchSize = 1, ArrivalRate arrivalRate = {}) {
+        Stopwatch<TscClock> stopwatch;
+
+        auto jobSystem = std::make_unique<typename JobSystemFor<QueueT, true>::type>(jobs, queueCapacity);
+        jobSystem->StartWorkers(numProducers, numConsumers, batchSize, arrivalRate);
+
+        auto cpuStart = getProcessCpuTime();
+        stopwatch.Reset();
+        jobSystem->ReleaseWorkers();
         jobSystem->WaitForJobs(numJobs);
+        auto elapsed = stopwatch.Tick();
+        auto cpuTime = getProcessCpuTime() - cpuStart;
+
         jobSystem->StopWorkers();
 
         return {
             jobSystem->GetLatencies(),
+            jobSystem->GetCorrectedLatencies(),
+            elapsed,
+            cpuTime,
         };
     }
 
 
 protected:
-    inline static std::vector<std::unique_ptr<Job>> jobs;
+    static constexpr size_t intrusiveJobPoolCopies = 256;
+
+    // Job pools are created once per factory and reused by every Benchmark of this queue type
+    inline static std::map<JobPoolFactory, std::vector<std::unique_ptr<Job>>> jobPools;
+
+    std::vector<std::unique_ptr<Job>>& jobs;
+    size_t queueCapacity;
 };
\ No newline at end of file
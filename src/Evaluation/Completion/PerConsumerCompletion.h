@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+
+/// Counts completed jobs without a shared hot cache line. Each consumer counts into a plain local variable and every
+/// publishInterval jobs (or whenever its queue is empty) stores the total into its own padded slot. Totals are only
+/// summed when someone asks: by a consumer after it publishes once WaitFor has set a target, and by GetCount.
+/// The waiter is woken exactly once, by whichever consumer first sees the published sum reach the target, so the run is
+/// stopped at most numConsumers * (publishInterval - 1) jobs late. GetCount is exact once the consumers have exited.
+class PerConsumerCompletion {
+    static constexpr size_t noTarget = std::numeric_limits<size_t>::max();
+
+    struct alignas(std::hardware_destructive_interference_size) Slot {
+        std::atomic<size_t> completed{0};
+    };
+public:
+    static std::string GetName() { return "Per-Consumer Counters"; }
+
+    static constexpr size_t publishInterval = 64;
+
+    class Counter {
+    public:
+        Counter(PerConsumerCompletion& completion, int consumerIndex)
+            : completion(completion), slot(completion.slots[consumerIndex]) { }
+
+        ~Counter() { Flush(); }
+
+        Counter(const Counter&) = delete;
+        Counter& operator=(const Counter&) = delete;
+
+        void Add(size_t count) {
+            completed += count;
+            if (completed - published >= publishInterval) Flush();
+        }
+
+        // Publishes the jobs counted since the last flush, consumers call this when they run out of work
+        void Flush() {
+            if (completed == published) return;
+            published = completed;
+            // seq_cst pairs with WaitFor: either it sees this count or this consumer sees its target
+            slot.completed.store(completed, std::memory_order_seq_cst);
+            completion.checkTarget();
+        }
+
+    private:
+        PerConsumerCompletion& completion;
+        Slot& slot;
+        size_t completed = 0;
+        size_t published = 0;
+    };
+
+    void Reset(int numConsumers) {
+        slots = std::make_unique<Slot[]>(numConsumers);
+        numSlots = numConsumers;
+        target.store(noTarget);
+        signaled = false;
+    }
+
+    // Blocks until the consumers have completed numJobs jobs or Cancel is called
+    void WaitFor(size_t numJobs) {
+        target.store(numJobs, std::memory_order_seq_cst);
+        if (GetCount() >= numJobs) signal();
+
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this] { return signaled.load(); });
+    }
+
+    void Cancel() {
+        signal();
+    }
+
+    [[nodiscard]] size_t GetCount() const {
+        size_t total = 0;
+        for (int i = 0; i < numSlots; i++) {
+            total += slots[i].completed.load(std::memory_order_seq_cst);
+        }
+        return total;
+    }
+
+private:
+    void checkTarget() {
+        size_t numJobs = target.load(std::memory_order_seq_cst);
+        if (numJobs == noTarget || signaled.load(std::memory_order_relaxed)) return;
+        if (GetCount() >= numJobs) signal();
+    }
+
+    void signal() {
+        if (signaled.exchange(true)) return;
+        std::lock_guard<std::mutex> lock(mtx);
+        cv.notify_all();
+    }
+
+    std::unique_ptr<Slot[]> slots;
+    int numSlots = 0;
+
+    alignas(std::hardware_destructive_interference_size) std::atomic<size_t> target{noTarget};
+    std::atomic<bool> signaled{false};
+
+    std::mutex mtx;
+    std::condition_variable cv;
+};
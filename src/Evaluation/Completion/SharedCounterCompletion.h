@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+/// The original completion path: every completed job increments one shared atomic and notifies the condition variable
+/// WaitFor sleeps on. Kept to measure how much that costs next to PerConsumerCompletion.
+class SharedCounterCompletion {
+public:
+    static std::string GetName() { return "Shared Counter + Notify"; }
+
+    class Counter {
+    public:
+        Counter(SharedCounterCompletion& completion, int /*consumerIndex*/) : completion(completion) { }
+
+        void Add(size_t count) {
+            completion.numJobsCompleted += count;
+            completion.cv.notify_one();
+        }
+
+        void Flush() { }
+
+    private:
+        SharedCounterCompletion& completion;
+    };
+
+    void Reset(int /*numConsumers*/) {
+        numJobsCompleted = 0;
+        cancelled = false;
+    }
+
+    void WaitFor(size_t numJobs) {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this, numJobs] {
+            return numJobsCompleted >= numJobs || cancelled;
+        });
+    }
+
+    void Cancel() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            cancelled = true;
+        }
+        cv.notify_all();
+    }
+
+    [[nodiscard]] size_t GetCount() const {
+        return numJobsCompleted.load();
+    }
+
+private:
+    std::atomic<size_t> numJobsCompleted = 0;
+    std::atomic<bool> cancelled = false;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <Job.h>
+
+#include "LatencyHistogram.h"
+#include "TscClock.h"
+#include "Wait/CpuRelax.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+// What latency runs put in the queue instead of the shared Job: one envelope per enqueue, so every enqueue keeps its
+// own timestamp even when the same Job is in the queue many times. Running the envelope runs the wrapped job and then
+// hands the envelope back to the producer's JobEnvelopeRing.
+struct alignas(std::hardware_destructive_interference_size) JobEnvelope final : Job {
+    Job* job = nullptr;
+    TscClock::time_point enqueueTime;
+    // When the job was due under the producer's arrival schedule (see Arrivals.h), enqueueTime if it has none. Latency
+    // from here also counts the time the producer spent stalled before it got to enqueue the job. Set by Acquire and
+    // Stamp.
+    TscClock::time_point intendedTime;
+    uint32_t producerId = 0;
+    uint64_t sequence = 0; // per producer, in enqueue order
+
+    void operator()() override {
+        job->operator()();
+        Release();
+    }
+
+    // Called right before the envelope is enqueued. A job enqueued ahead of schedule (the run is stopping) counts as due
+    // when it was enqueued, so the corrected latency is never below the raw one.
+    void Stamp(TscClock::time_point now) {
+        enqueueTime = now;
+        intendedTime = std::min(intendedTime, now);
+    }
+
+    // Lets the producer reuse the envelope, also used by the producer itself when the queue dropped it
+    void Release() {
+        inFlight.store(false, std::memory_order_release);
+    }
+
+    std::atomic<bool> inFlight{false};
+};
+
+// Fixed pool of envelopes owned by one producer, allocated up front so enqueueing never touches the heap.
+// Envelopes are handed out in ring order; one that is still in a queue is skipped, and if every envelope is in flight
+// the producer waits, which caps how far a producer can run ahead of the consumers at the ring's capacity.
+class JobEnvelopeRing {
+public:
+    static constexpr size_t defaultCapacity = 1 << 16;
+
+    explicit JobEnvelopeRing(uint32_t producerId, size_t capacity = defaultCapacity)
+        : envelopes(new JobEnvelope[capacity]), capacity(capacity) {
+        for (size_t i = 0; i < capacity; i++) {
+            envelopes[i].producerId = producerId;
+        }
+    }
+
+    // Returns a free envelope wrapping job, waiting while all of them are in flight. Returns nullptr if running turns
+    // false while waiting. due is when the arrival schedule wanted the job sent, producers without one leave it at max
+    // so the job counts as due when it is enqueued.
+    JobEnvelope* Acquire(Job* job, const std::atomic<bool>& running,
+                         TscClock::time_point due = TscClock::time_point::max()) {
+        while (true) {
+            for (size_t scanned = 0; scanned < capacity; scanned++) {
+                JobEnvelope& envelope = envelopes[next];
+                next = next + 1 == capacity ? 0 : next + 1;
+
+                // acquire pairs with Release so the consumer is done reading the envelope before it is rewritten
+                if (!envelope.inFlight.load(std::memory_order_acquire)) {
+                    envelope.inFlight.store(true, std::memory_order_relaxed);
+                    envelope.job = job;
+                    envelope.sequence = nextSequence++;
+                    envelope.intendedTime = due;
+                    return &envelope;
+                }
+            }
+            if (!running) return nullptr;
+            cpuRelax();
+        }
+    }
+
+private:
+    std::unique_ptr<JobEnvelope[]> envelopes;
+    size_t capacity;
+    size_t next = 0;
+    uint64_t nextSequence = 0;
+};
+
+// One consumer's latencies, recorded twice: raw, from when each job was enqueued, and corrected for coordinated
+// omission, from when it was due. A producer that stalls on a slow queue enqueues its backlog late, so the raw latency
+// leaves out the time those jobs spent waiting to be sent, the corrected latency is what a client sending on schedule
+// would have seen. In closed loop runs the two are the same.
+struct EnvelopeLatencies {
+    LatencyHistogram raw;
+    LatencyHistogram corrected;
+
+    void Record(const JobEnvelope& envelope, TscClock::time_point dequeueTime) {
+        raw.Record(dequeueTime - envelope.enqueueTime);
+        corrected.Record(dequeueTime - envelope.intendedTime);
+    }
+
+    void Merge(const EnvelopeLatencies& other) {
+        raw.Merge(other.raw);
+        corrected.Merge(other.corrected);
+    }
+
+    void Reset() {
+        raw.Reset();
+        corrected.Reset();
+    }
+};
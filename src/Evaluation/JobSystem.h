@@ -1,7 +1,16 @@
 #pragma once
 
 #include <Job.h>
-#include <IQueue.h>
+
+#include "QueueTraits.h"
+#include "Backpressure.h"
+#include "QueueHandle.h"
+#include "Arrivals.h"
+#include "JobEnvelope.h"
+#include "LatencyHistogram.h"
+#include "WorkerPool.h"
+#include "Wait/SpinWaitStrategy.h"
+#include "Completion/PerConsumerCompletion.h"
 
 #include <iostream>
 #include <atomic>
@@ -9,15 +18,21 @@
 #include <thread>
 #include <vector>
 #include <memory>
-#include <mutex>
-#include <condition_variable>
 #include <chrono>
+#include <algorithm>
+#include <string>
 
-template<typename QueueT, bool measureLatency>
+// WaitStrategyT decides what an idle consumer does while the queue is empty (see Wait/), CompletionT how completed jobs
+// are counted and WaitForJobs is woken (see Completion/), fullQueuePolicy what a producer does when a bounded queue is
+// full (see Backpressure.h), useTokens whether workers pass the queue their tokens if it has them (see QueueHandle.h)
+template<typename QueueT, bool measureLatency, typename WaitStrategyT = SpinWaitStrategy, typename CompletionT = PerConsumerCompletion,
+         FullQueuePolicy fullQueuePolicy = FullQueuePolicy::Block, bool useTokens = true>
 class JobSystem {
-    static_assert(std::is_base_of_v<IQueue<Job*>, QueueT>);
+    static_assert(IsQueue<QueueT, Job*>::value, "QueueT must provide Enqueue, Dequeue, EnqueueBulk and DequeueBulk for Job*");
 public:
-    explicit JobSystem(const std::vector<std::unique_ptr<Job>>& jobs) : availableJobs(jobs) { }
+    // queueCapacity sizes queues with a runtime capacity, 0 keeps their default
+    explicit JobSystem(const std::vector<std::unique_ptr<Job>>& jobs, size_t queueCapacity = 0)
+        : queue(makeQueue<QueueT>(queueCapacity)), availableJobs(jobs) { }
 
     ~JobSystem() {
         if (running) {
@@ -25,94 +40,327 @@ public:
         }
     }
 
-    void StartWorkers(int numProducers, int numConsumers) {
+    // batchSize > 1 makes producers and consumers move jobs with EnqueueBulk/DequeueBulk, arrivalRate paces the producers
+    // (see Arrivals.h), by default they enqueue as fast as they can
+    // Returns once every worker is awake, they wait for ReleaseWorkers before touching the queue
+    void StartWorkers(int numProducers, int numConsumers, size_t batchSize = 1, ArrivalRate arrivalRate = {}) {
         running = true;
-        numJobsCompleted = 0;
-        if constexpr (measureLatency) latenciesCumulative.clear();
-
-        threads.reserve(numProducers + numConsumers);
-        for (int i = 0; i < numProducers; i++) {
-            threads.emplace_back([this, i] { producerEntry(i); });
-        }
-        for (int i = 0; i < numConsumers; i++) {
-            threads.emplace_back([this] { consumerEntry(); });
+        completion.Reset(numConsumers);
+        numFullEnqueues = 0;
+        numDropped = 0;
+        this->batchSize = std::max<size_t>(batchSize, 1);
+        this->numProducers = numProducers;
+        this->arrivalRate = arrivalRate;
+        if constexpr (measureLatency) {
+            // histograms are allocated here so recording inside the run never allocates
+            if (!latencies) latencies = std::make_unique<EnvelopeLatencies>();
+            latencies->Reset();
+            consumerLatencies.resize(numConsumers);
+            for (auto& histograms : consumerLatencies) {
+                if (!histograms) histograms = std::make_unique<EnvelopeLatencies>();
+                histograms->Reset();
+            }
+            // rings are only ever added, envelopes left in the queue by an earlier run must stay valid
+            while (envelopeRings.size() < (size_t)numProducers) {
+                envelopeRings.push_back(std::make_unique<JobEnvelopeRing>((uint32_t)envelopeRings.size()));
+            }
         }
+
+        // producers run on the pool's first numProducers workers, consumers on the ones after them
+        pool.Start(numProducers + numConsumers, [this, numProducers](int index) {
+            if (index < numProducers) producerEntry(index);
+            else consumerEntry(index - numProducers);
+        });
+    }
+
+    // Lets the workers started by StartWorkers begin producing and consuming. Split from StartWorkers so the caller can
+    // take its baselines once every worker is already awake.
+    void ReleaseWorkers() {
+        arrivalStart = TscClock::now();
+        pool.Release();
     }
 
     void StopWorkers() {
         running = false;
-        cv.notify_all();
-        for (auto& thread : threads) {
-            if (thread.joinable()) {
-                thread.join();
+        waitStrategy.NotifyAll();
+        completion.Cancel();
+        pool.Join();
+
+        if constexpr (measureLatency) {
+            for (auto& histograms : consumerLatencies) {
+                latencies->Merge(*histograms);
             }
         }
-        threads.clear();
     }
 
     void WaitForJobs(size_t numJobs) {
-        std::unique_lock<std::mutex> lock(mtx);
-        cv.wait(lock, [this, numJobs] {
-            return numJobsCompleted >= numJobs || !running;
-        });
+        completion.WaitFor(numJobs);
     }
 
+    // Exact once the workers are stopped, may lag behind the consumers while they are running
     [[nodiscard]] size_t GetCompletedJobCount() const {
-        return numJobsCompleted.load();
+        return completion.GetCount();
+    }
+
+    // Number of enqueue calls that found a bounded queue full, exact once the workers are stopped
+    [[nodiscard]] size_t GetFullEnqueueCount() const {
+        return numFullEnqueues.load();
+    }
+
+    // Number of jobs dropped because the queue was full, FullQueuePolicy::Drop only
+    [[nodiscard]] size_t GetDroppedCount() const {
+        return numDropped.load();
     }
 
-    [[nodiscard]] std::vector<std::chrono::high_resolution_clock::duration> GetLatencies() {
-        std::lock_guard<std::mutex> lock(latenciesMutex);
-        return latenciesCumulative;
+    // Latency runs only, every consumer's latencies merged by StopWorkers
+    [[nodiscard]] const LatencyHistogram& GetLatencies() const {
+        return latencies->raw;
+    }
+
+    // Latency runs only, latencies from when each job was due rather than enqueued (see EnvelopeLatencies)
+    [[nodiscard]] const LatencyHistogram& GetCorrectedLatencies() const {
+        return latencies->corrected;
     }
 
 private:
     void producerEntry(int index) {
-        int nextJobType = index % availableJobs.size();
-        while (running) {
-            Job* jobToInsert = availableJobs[nextJobType].get();
-            if constexpr (measureLatency) jobToInsert->enqueueTime = std::chrono::high_resolution_clock::now();
-            queue.Enqueue(jobToInsert);
+        size_t nextJobType = index % availableJobs.size();
+        if constexpr (QueueIsIntrusive<QueueT>::value) {
+            // spread producers over the pool so they don't race each other to claim the same jobs
+            nextJobType = index * availableJobs.size() / numProducers;
+        }
+        EnqueueStats stats;
+        ProducerHandle<QueueT, useTokens> producer(queue);
+        ArrivalSchedule arrivals(arrivalRate, numProducers, index, arrivalStart);
+
+        if (batchSize == 1) {
+            while (running) {
+                TscClock::time_point due = TscClock::time_point::max();
+                if (arrivals.IsOpenLoop()) due = arrivals.WaitForNext(running);
+                Job* jobToInsert = takeNextJob(nextJobType);
+                if (jobToInsert == nullptr) break;
+                if constexpr (measureLatency) {
+                    JobEnvelope* envelope = envelopeRings[index]->Acquire(jobToInsert, running, due);
+                    if (envelope == nullptr) break;
+                    envelope->Stamp(TscClock::now());
+                    jobToInsert = envelope;
+                    enqueueEnvelopes(producer, &jobToInsert, 1, stats);
+                } else {
+                    enqueueJobs<fullQueuePolicy>(producer, &jobToInsert, 1, running, stats);
+                }
+                waitStrategy.Notify();
+            }
+        } else {
+            std::vector<Job*> batch(batchSize);
+            while (running) {
+                size_t count = 0;
+                while (count < batch.size()) {
+                    // open loop batches go out once batchSize jobs have arrived
+                    TscClock::time_point due = TscClock::time_point::max();
+                    if (arrivals.IsOpenLoop()) due = arrivals.WaitForNext(running);
+                    Job* jobToInsert = takeNextJob(nextJobType);
+                    if (jobToInsert == nullptr) break;
+                    if constexpr (measureLatency) {
+                        jobToInsert = envelopeRings[index]->Acquire(jobToInsert, running, due);
+                        if (jobToInsert == nullptr) break;
+                    }
+                    batch[count++] = jobToInsert;
+                }
+                if constexpr (measureLatency) {
+                    auto enqueueTime = TscClock::now();
+                    for (size_t i = 0; i < count; i++) static_cast<JobEnvelope*>(batch[i])->Stamp(enqueueTime);
+                    enqueueEnvelopes(producer, batch.data(), count, stats);
+                } else {
+                    enqueueJobs<fullQueuePolicy>(producer, batch.data(), count, running, stats);
+                }
+                waitStrategy.Notify();
+            }
+        }
+
+        numFullEnqueues += stats.fullEnqueues;
+        numDropped += stats.dropped;
+    }
+
+    // Enqueues JobEnvelopes in latency runs, any that weren't enqueued (dropped, or the run stopped while the queue was
+    // full) go straight back to their ring
+    void enqueueEnvelopes(ProducerHandle<QueueT, useTokens>& producer, Job* const* envelopes, size_t count, EnqueueStats& stats) {
+        size_t enqueued = enqueueJobs<fullQueuePolicy>(producer, envelopes, count, running, stats);
+        for (size_t i = enqueued; i < count; i++) static_cast<JobEnvelope*>(envelopes[i])->Release();
+    }
+
+    // Returns the next job to enqueue. Intrusive queues link the job itself, so jobs that are still in the queue are
+    // skipped (unless it is a latency run, where the queue links the envelope instead), returns nullptr if the workers
+    // are stopped while waiting for one.
+    Job* takeNextJob(size_t& nextJobType) {
+        while (true) {
+            Job* job = availableJobs[nextJobType].get();
             nextJobType = (nextJobType + 1) % availableJobs.size();
+
+            if constexpr (!QueueIsIntrusive<QueueT>::value || measureLatency) {
+                return job;
+            } else {
+                if (job->TryLink()) return job;
+                if (!running) return nullptr;
+            }
         }
     }
 
-    void consumerEntry() {
-        std::vector<std::chrono::high_resolution_clock::duration> latencies;
+    void consumerEntry(int index) {
+        EnvelopeLatencies* latencies = measureLatency ? consumerLatencies[index].get() : nullptr;
+        typename WaitStrategyT::Waiter waiter(waitStrategy);
+        typename CompletionT::Counter completed(completion, index);
+        ConsumerHandle<QueueT, useTokens> consumer(queue);
 
-        Job* job;
-        while (running) {
-            if (queue.Dequeue(job)) {
+        if (batchSize == 1) {
+            Job* job;
+            while (waitForWork(waiter, completed, [&] { return consumer.Dequeue(job) ? 1 : 0; })) {
                 if constexpr (measureLatency) {
-                    auto dequeueTime = std::chrono::high_resolution_clock::now();
-                    auto latency = dequeueTime - job->enqueueTime;
-                    latencies.push_back(latency);
+                    auto dequeueTime = TscClock::now();
+                    latencies->Record(*static_cast<JobEnvelope*>(job), dequeueTime);
                 }
 
                 job->operator()();
-                numJobsCompleted++;
-                cv.notify_one();
+                completed.Add(1);
+            }
+        } else {
+            std::vector<Job*> batch(batchSize);
+            size_t count;
+            while ((count = waitForWork(waiter, completed, [&] { return consumer.DequeueBulk(batch.data(), batch.size()); })) > 0) {
+                if constexpr (measureLatency) {
+                    auto dequeueTime = TscClock::now();
+                    for (size_t i = 0; i < count; i++) {
+                        latencies->Record(*static_cast<JobEnvelope*>(batch[i]), dequeueTime);
+                    }
+                }
+
+                for (size_t i = 0; i < count; i++) {
+                    batch[i]->operator()();
+                }
+                completed.Add(count);
             }
         }
 
-        if constexpr (measureLatency) {
-            std::lock_guard lock(latenciesMutex);
-            latenciesCumulative.insert(latenciesCumulative.end(), latencies.begin(), latencies.end());
+        completed.Flush();
+    }
+
+    // Calls tryTake until it takes at least one job, idling with the wait strategy while the queue is empty.
+    // Returns the number of jobs taken, or 0 once the workers are stopped.
+    template<typename TryTake>
+    size_t waitForWork(typename WaitStrategyT::Waiter& waiter, typename CompletionT::Counter& completed, TryTake&& tryTake) {
+        while (running) {
+            if (size_t count = tryTake()) {
+                waiter.Reset();
+                return count;
+            }
+            // out of work, so publish what was done before idling, WaitForJobs may be waiting on it
+            completed.Flush();
+            if constexpr (WaitStrategyT::blocks) {
+                // announce the wait first, then look again so an enqueue racing with it can't be missed
+                waiter.PrepareWait();
+                if (size_t count = tryTake()) {
+                    waiter.CancelWait();
+                    waiter.Reset();
+                    return count;
+                }
+                if (!running) {
+                    waiter.CancelWait();
+                    return 0;
+                }
+            }
+            waiter.CommitWait();
         }
+        return 0;
     }
 
 private:
+    // Latency runs only, one per producer. Declared before the queue so they outlive anything still in it.
+    std::vector<std::unique_ptr<JobEnvelopeRing>> envelopeRings;
+
     QueueT queue;
+    WaitStrategyT waitStrategy;
+    CompletionT completion;
     const std::vector<std::unique_ptr<Job>>& availableJobs;
 
+    size_t batchSize = 1;
+    int numProducers = 1;
+    ArrivalRate arrivalRate;
+    TscClock::time_point arrivalStart;
+
     std::atomic<bool> running = false;
-    std::atomic<size_t> numJobsCompleted = 0;
+    std::atomic<size_t> numFullEnqueues = 0;
+    std::atomic<size_t> numDropped = 0;
+
+    WorkerPool& pool = WorkerPool::Shared();
+
+    // Latency runs only, each consumer records into its own histogram
+    std::vector<std::unique_ptr<EnvelopeLatencies>> consumerLatencies;
+    std::unique_ptr<EnvelopeLatencies> latencies;
+};
+
+// Maps a benchmarked type to the job system that runs it. Queues run on the shared-queue JobSystem, scheduler types
+// (e.g. WorkStealing<InboxQueueT>) specialize this.
+template<typename QueueT, bool measureLatency>
+struct JobSystemFor {
+    using type = JobSystem<QueueT, measureLatency>;
+};
+
+// Benchmarks QueueT with consumers idling according to WaitStrategyT, e.g. in runThroughput's queue list
+template<typename QueueT, typename WaitStrategyT>
+struct WithWaitStrategy {
+    static std::string GetName() { return QueueT::GetName() + " [" + WaitStrategyT::GetName() + "]"; }
+
+    static constexpr int maxProducers = QueueMaxProducers<QueueT>::value;
+    static constexpr int maxConsumers = QueueMaxConsumers<QueueT>::value;
+    static constexpr bool isIntrusive = QueueIsIntrusive<QueueT>::value;
+};
+
+template<typename QueueT, typename WaitStrategyT, bool measureLatency>
+struct JobSystemFor<WithWaitStrategy<QueueT, WaitStrategyT>, measureLatency> {
+    using type = JobSystem<QueueT, measureLatency, WaitStrategyT>;
+};
 
-    std::vector<std::thread> threads;
+// Benchmarks QueueT with completed jobs counted by CompletionT instead of the default PerConsumerCompletion
+template<typename QueueT, typename CompletionT>
+struct WithCompletion {
+    static std::string GetName() { return QueueT::GetName() + " [" + CompletionT::GetName() + "]"; }
 
-    std::mutex mtx;
-    std::condition_variable cv;
+    static constexpr int maxProducers = QueueMaxProducers<QueueT>::value;
+    static constexpr int maxConsumers = QueueMaxConsumers<QueueT>::value;
+    static constexpr bool isIntrusive = QueueIsIntrusive<QueueT>::value;
+};
 
-    std::vector<std::chrono::high_resolution_clock::duration> latenciesCumulative;
-    std::mutex latenciesMutex;
-};
\ No newline at end of file
+template<typename QueueT, typename CompletionT, bool measureLatency>
+struct JobSystemFor<WithCompletion<QueueT, CompletionT>, measureLatency> {
+    using type = JobSystem<QueueT, measureLatency, SpinWaitStrategy, CompletionT>;
+};
+
+// Benchmarks QueueT with producers dropping the jobs that don't fit when the bounded queue is full, instead of waiting
+template<typename QueueT>
+struct DropWhenFull {
+    static std::string GetName() { return QueueT::GetName() + " [Drop When Full]"; }
+
+    static constexpr int maxProducers = QueueMaxProducers<QueueT>::value;
+    static constexpr int maxConsumers = QueueMaxConsumers<QueueT>::value;
+    static constexpr bool isIntrusive = QueueIsIntrusive<QueueT>::value;
+};
+
+template<typename QueueT, bool measureLatency>
+struct JobSystemFor<DropWhenFull<QueueT>, measureLatency> {
+    using type = JobSystem<QueueT, measureLatency, SpinWaitStrategy, PerConsumerCompletion, FullQueuePolicy::Drop>;
+};
+
+// Benchmarks QueueT with workers calling the plain operations even though it has tokens, to compare with its tokens
+template<typename QueueT>
+struct WithoutTokens {
+    static_assert(QueueHasTokens<QueueT>::value, "QueueT has no tokens to leave out");
+    static std::string GetName() { return QueueT::GetName() + " [No Tokens]"; }
+
+    static constexpr int maxProducers = QueueMaxProducers<QueueT>::value;
+    static constexpr int maxConsumers = QueueMaxConsumers<QueueT>::value;
+    static constexpr bool isIntrusive = QueueIsIntrusive<QueueT>::value;
+};
+
+template<typename QueueT, bool measureLatency>
+struct JobSystemFor<WithoutTokens<QueueT>, measureLatency> {
+    using type = JobSystem<QueueT, measureLatency, SpinWaitStrategy, PerConsumerCompletion, FullQueuePolicy::Block, false>;
+};
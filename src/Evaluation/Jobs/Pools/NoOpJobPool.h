@@ -0,0 +1,16 @@
+#pragma once
+
+#include <Job.h>
+
+#include "../Synthetic/NoOpJob.h"
+
+#include <memory>
+#include <vector>
+
+// Only NoOpJobs, so the measurement is the queue and job system overhead alone. Several instances so consumers aren't
+// all incrementing the same counter.
+inline void createNoOpJobPool(std::vector<std::unique_ptr<Job>>& dest) {
+    for (int i = 0; i < 64; i++) {
+        dest.push_back(std::make_unique<NoOpJob>());
+    }
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/// Fixed-memory latency recorder in the style of HdrHistogram (http://hdrhistogram.org). Values (nanoseconds) below
+/// subBucketCount are counted exactly; above that each power-of-two range is split into subBucketCount / 2 linear
+/// buckets, so a recorded value is off by at most 1 / (subBucketCount / 2) ~ 0.2% of itself. All memory is allocated
+/// in the constructor and Record is an index computation plus an increment, so recording doesn't disturb the run.
+/// Not thread safe: give each thread its own histogram and Merge them afterwards.
+class LatencyHistogram {
+public:
+    static constexpr int subBucketBits = 10;
+    static constexpr uint64_t subBucketCount = uint64_t(1) << subBucketBits;
+    static constexpr uint64_t subBucketHalfCount = subBucketCount / 2;
+    // one exact range below subBucketCount, then a half range for every remaining power of two up to 2^64
+    static constexpr size_t bucketCount = (64 - subBucketBits + 2) * subBucketHalfCount;
+
+    LatencyHistogram() : counts(bucketCount, 0) { }
+
+    void Record(std::chrono::nanoseconds latency) {
+        Record(latency.count() < 0 ? 0 : (uint64_t)latency.count());
+    }
+
+    void Record(uint64_t ns) {
+        counts[indexOf(ns)]++;
+        totalCount++;
+        sum += ns;
+        min = std::min(min, ns);
+        max = std::max(max, ns);
+    }
+
+    void Merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < bucketCount; i++) {
+            counts[i] += other.counts[i];
+        }
+        totalCount += other.totalCount;
+        sum += other.sum;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+
+    void Reset() {
+        std::fill(counts.begin(), counts.end(), 0);
+        totalCount = 0;
+        sum = 0;
+        min = std::numeric_limits<uint64_t>::max();
+        max = 0;
+    }
+
+    [[nodiscard]] uint64_t GetCount() const { return totalCount; }
+    [[nodiscard]] double GetMean() const { return totalCount == 0 ? 0.0 : (double)sum / (double)totalCount; }
+    [[nodiscard]] uint64_t GetMin() const { return totalCount == 0 ? 0 : min; }
+    [[nodiscard]] uint64_t GetMax() const { return max; }
+
+    // Smallest recorded value (rounded up to its bucket's upper bound) that percentile % of the values are at or below,
+    // e.g. GetValueAtPercentile(99.9)
+    [[nodiscard]] uint64_t GetValueAtPercentile(double percentile) const {
+        if (totalCount == 0) return 0;
+        percentile = std::clamp(percentile, 0.0, 100.0);
+        auto target = (uint64_t)(percentile / 100.0 * (double)totalCount + 0.5);
+        target = std::clamp<uint64_t>(target, 1, totalCount);
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < bucketCount; i++) {
+            seen += counts[i];
+            if (seen >= target) {
+                return std::min(highestValueOf(i), max);
+            }
+        }
+        return max;
+    }
+
+private:
+    static size_t indexOf(uint64_t value) {
+        if (value < subBucketCount) return (size_t)value;
+        int msb = 63 - countLeadingZeros(value);
+        // shift so the value lands in [subBucketHalfCount, subBucketCount)
+        int shift = msb - (subBucketBits - 1);
+        return (size_t)((shift + 1) * subBucketHalfCount + ((value >> shift) - subBucketHalfCount));
+    }
+
+    static uint64_t highestValueOf(size_t index) {
+        if (index < subBucketCount) return index;
+        size_t shift = index / subBucketHalfCount - 1;
+        uint64_t lowest = (index % subBucketHalfCount + subBucketHalfCount) << shift;
+        return lowest + ((uint64_t(1) << shift) - 1);
+    }
+
+    static int countLeadingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return 63 - (int)index;
+#else
+        return __builtin_clzll(value);
+#endif
+    }
+
+    std::vector<uint64_t> counts;
+    uint64_t totalCount = 0;
+    uint64_t sum = 0;
+    uint64_t min = std::numeric_limits<uint64_t>::max();
+    uint64_t max = 0;
+};
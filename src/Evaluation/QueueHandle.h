@@ -0,0 +1,82 @@
+#pragma once
+
+#include "QueueTraits.h"
+
+#include <cstddef>
+
+// Stands in for the token of a queue without tokens, or when tokens are turned off
+struct NoQueueToken {
+    template<typename QueueT>
+    explicit NoQueueToken(QueueT&) { }
+};
+
+template<typename QueueT, bool withTokens>
+struct QueueTokenTypes {
+    using Producer = NoQueueToken;
+    using Consumer = NoQueueToken;
+};
+template<typename QueueT>
+struct QueueTokenTypes<QueueT, true> {
+    using Producer = typename QueueT::ProducerToken;
+    using Consumer = typename QueueT::ConsumerToken;
+};
+
+// One thread's producer side of a queue. Passes the queue's ProducerToken to every call if it has tokens (and useTokens
+// is set), otherwise calls the plain operations. Made once per thread, e.g. at the start of producerEntry.
+template<typename QueueT, bool useTokens = true>
+class ProducerHandle {
+public:
+    static constexpr bool usesTokens = useTokens && QueueHasTokens<QueueT>::value;
+
+    explicit ProducerHandle(QueueT& queue) : queue(queue), token(queue) { }
+
+    ProducerHandle(const ProducerHandle&) = delete;
+    ProducerHandle& operator=(const ProducerHandle&) = delete;
+
+    template<typename T>
+    void Enqueue(const T& value) {
+        if constexpr (usesTokens) queue.Enqueue(token, value);
+        else queue.Enqueue(value);
+    }
+
+    template<typename T>
+    void EnqueueBulk(const T* values, size_t count) {
+        if constexpr (usesTokens) queue.EnqueueBulk(token, values, count);
+        else queue.EnqueueBulk(values, count);
+    }
+
+    // For the operations tokens don't cover (TryEnqueue, EnqueueWhile)
+    QueueT& Queue() { return queue; }
+
+private:
+    QueueT& queue;
+    typename QueueTokenTypes<QueueT, usesTokens>::Producer token;
+};
+
+// One thread's consumer side of a queue, see ProducerHandle
+template<typename QueueT, bool useTokens = true>
+class ConsumerHandle {
+public:
+    static constexpr bool usesTokens = useTokens && QueueHasTokens<QueueT>::value;
+
+    explicit ConsumerHandle(QueueT& queue) : queue(queue), token(queue) { }
+
+    ConsumerHandle(const ConsumerHandle&) = delete;
+    ConsumerHandle& operator=(const ConsumerHandle&) = delete;
+
+    template<typename T>
+    bool Dequeue(T& out) {
+        if constexpr (usesTokens) return queue.Dequeue(token, out);
+        else return queue.Dequeue(out);
+    }
+
+    template<typename T>
+    size_t DequeueBulk(T* out, size_t max) {
+        if constexpr (usesTokens) return queue.DequeueBulk(token, out, max);
+        else return queue.DequeueBulk(out, max);
+    }
+
+private:
+    QueueT& queue;
+    typename QueueTokenTypes<QueueT, usesTokens>::Consumer token;
+};
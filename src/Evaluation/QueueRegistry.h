@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Benchmark.h"
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Queues with a memory reclamation policy expose it as QueueT::Reclaimer (see LinkedListQueue)
+template<typename QueueT, typename = void>
+struct QueueHasReclaimer : std::false_type { };
+template<typename QueueT>
+struct QueueHasReclaimer<QueueT, std::void_t<typename QueueT::Reclaimer>> : std::true_type { };
+
+// A benchmarkable queue type compiled into the executable, looked up by id at runtime
+struct QueueRegistration {
+    std::string id;
+    std::string name;
+
+    bool (*supportsThreadCounts)(int numProducers, int numConsumers);
+    // capacity sizes queues with a runtime capacity, 0 keeps their default. arrivalRate paces the producers.
+    ThroughputResult (*runThroughput)(JobPoolFactory jobPool, size_t capacity, size_t numJobs, int numProducers, int numConsumers, size_t batchSize, ArrivalRate arrivalRate);
+    LatencyResult (*runLatency)(JobPoolFactory jobPool, size_t capacity, size_t numJobs, int numProducers, int numConsumers, size_t batchSize, ArrivalRate arrivalRate);
+
+    // Set for queues constructed with their capacity, which suites with capacities run once per capacity
+    bool hasRuntimeCapacity = false;
+
+    // Only set for queues with a Reclaimer, used by reclamation suites. resetReclamationStats is called between runs and
+    // first frees whatever earlier runs left retired (the pool's threads and their records outlive a run, and other
+    // queues may share the reclaimer), so the high-water only counts this run's nodes.
+    void (*resetReclamationStats)() = nullptr;
+    size_t (*getRetiredHighWater)() = nullptr;
+    size_t nodeSize = 0;
+};
+
+// Every queue type main can benchmark, so suites can pick queues by id without recompiling
+class QueueRegistry {
+public:
+    template<typename QueueT>
+    void Add(const std::string& id) {
+        if (Find(id) != nullptr) throw std::logic_error("Queue id registered twice: " + id);
+
+        QueueRegistration registration;
+        registration.id = id;
+        registration.name = QueueT::GetName();
+        registration.supportsThreadCounts = &Benchmark<QueueT>::SupportsThreadCounts;
+        registration.runThroughput = [](JobPoolFactory jobPool, size_t capacity, size_t numJobs, int numProducers, int numConsumers, size_t batchSize,
+                                        ArrivalRate arrivalRate) {
+            Benchmark<QueueT> benchmark(jobPool, capacity);
+            return benchmark.RunThroughput(numJobs, numProducers, numConsumers, batchSize, arrivalRate);
+        };
+        registration.runLatency = [](JobPoolFactory jobPool, size_t capacity, size_t numJobs, int numProducers, int numConsumers, size_t batchSize,
+                                     ArrivalRate arrivalRate) {
+            Benchmark<QueueT> benchmark(jobPool, capacity);
+            return benchmark.RunLatency(numJobs, numProducers, numConsumers, batchSize, arrivalRate);
+        };
+        registration.hasRuntimeCapacity = QueueHasRuntimeCapacity<QueueT>::value;
+        if constexpr (QueueHasReclaimer<QueueT>::value) {
+            registration.resetReclamationStats = [] {
+                QueueT::Reclaimer::Drain();
+                QueueT::Reclaimer::ResetStats();
+            };
+            registration.getRetiredHighWater = [] { return QueueT::Reclaimer::GetRetiredHighWater(); };
+            registration.nodeSize = QueueT::nodeSize;
+        }
+        registrations.push_back(std::move(registration));
+    }
+
+    // Returns nullptr if no queue was registered under id
+    [[nodiscard]] const QueueRegistration* Find(const std::string& id) const {
+        for (const auto& registration : registrations) {
+            if (registration.id == id) return &registration;
+        }
+        return nullptr;
+    }
+
+    [[nodiscard]] const std::vector<QueueRegistration>& GetAll() const {
+        return registrations;
+    }
+
+private:
+    std::vector<QueueRegistration> registrations;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+// Compile-time queue concept. Job systems call queues through their concrete type, so every operation can be inlined
+// instead of going through IQueue's virtual functions. A queue of T needs:
+//   void Enqueue(const T&), bool Dequeue(T&), void EnqueueBulk(const T*, size_t), size_t DequeueBulk(T*, size_t)
+template<typename QueueT, typename T, typename = void>
+struct IsQueue : std::false_type { };
+template<typename QueueT, typename T>
+struct IsQueue<QueueT, T, std::void_t<
+        decltype(std::declval<QueueT&>().Enqueue(std::declval<const T&>())),
+        decltype(std::declval<QueueT&>().EnqueueBulk(std::declval<const T*>(), std::declval<size_t>()))>>
+    : std::bool_constant<
+        std::is_same_v<decltype(std::declval<QueueT&>().Dequeue(std::declval<T&>())), bool> &&
+        std::is_same_v<decltype(std::declval<QueueT&>().DequeueBulk(std::declval<T*>(), std::declval<size_t>())), size_t>> { };
+
+// Queues that only support a limited number of threads declare static constexpr int maxProducers/maxConsumers
+template<typename QueueT, typename = void>
+struct QueueMaxProducers : std::integral_constant<int, std::numeric_limits<int>::max()> { };
+template<typename QueueT>
+struct QueueMaxProducers<QueueT, std::void_t<decltype(QueueT::maxProducers)>> : std::integral_constant<int, QueueT::maxProducers> { };
+
+template<typename QueueT, typename = void>
+struct QueueMaxConsumers : std::integral_constant<int, std::numeric_limits<int>::max()> { };
+template<typename QueueT>
+struct QueueMaxConsumers<QueueT, std::void_t<decltype(QueueT::maxConsumers)>> : std::integral_constant<int, QueueT::maxConsumers> { };
+
+// Queues that link items through their IntrusiveMPSCHook declare static constexpr bool isIntrusive = true
+template<typename QueueT, typename = void>
+struct QueueIsIntrusive : std::false_type { };
+template<typename QueueT>
+struct QueueIsIntrusive<QueueT, std::void_t<decltype(QueueT::isIntrusive)>> : std::bool_constant<QueueT::isIntrusive> { };
+
+// Bounded queues report a full queue through bool TryEnqueue(const T&) and size_t TryEnqueueBulk(const T*, size_t)
+template<typename QueueT, typename = void>
+struct QueueHasTryEnqueue : std::false_type { };
+template<typename QueueT>
+struct QueueHasTryEnqueue<QueueT, std::void_t<decltype(&QueueT::TryEnqueue), decltype(&QueueT::TryEnqueueBulk)>> : std::true_type { };
+
+// Bounded queues that can wait for room until told to stop provide bool EnqueueWhile(const T&, const std::atomic<bool>&)
+// and size_t EnqueueBulkWhile(const T*, size_t, const std::atomic<bool>&)
+template<typename QueueT, typename = void>
+struct QueueHasEnqueueWhile : std::false_type { };
+template<typename QueueT>
+struct QueueHasEnqueueWhile<QueueT, std::void_t<decltype(&QueueT::EnqueueWhile), decltype(&QueueT::EnqueueBulkWhile)>> : std::true_type { };
+
+// Queues with a per-thread fast path declare ProducerToken and ConsumerToken types, each constructible from the queue,
+// and overload Enqueue/EnqueueBulk to take a ProducerToken& and Dequeue/DequeueBulk to take a ConsumerToken& first.
+// A thread makes one token per queue and passes it to every call, so the queue can keep that thread's state in it
+// instead of looking it up each time (see ProducerHandle in QueueHandle.h)
+template<typename QueueT, typename = void>
+struct QueueHasTokens : std::false_type { };
+template<typename QueueT>
+struct QueueHasTokens<QueueT, std::void_t<typename QueueT::ProducerToken, typename QueueT::ConsumerToken>> : std::true_type { };
+
+// Queues whose capacity is chosen at runtime can be constructed from a size_t capacity
+template<typename QueueT>
+struct QueueHasRuntimeCapacity : std::bool_constant<std::is_constructible_v<QueueT, size_t>> { };
+
+// Constructs QueueT with capacity if it has a runtime capacity and capacity isn't 0, otherwise default constructs it
+template<typename QueueT>
+QueueT makeQueue(size_t capacity) {
+    if constexpr (QueueHasRuntimeCapacity<QueueT>::value) {
+        if (capacity > 0) return QueueT(capacity);
+    }
+    return QueueT();
+}
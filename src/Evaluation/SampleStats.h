@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+// Summary of one configuration's per-iteration samples (throughput, or an iteration's mean latency). Iterations far
+// outside the rest (Tukey's fences, 1.5 interquartile ranges past the quartiles, once there are enough samples to have
+// quartiles) are treated as outliers, e.g. a run that shared the machine with something else, and left out of the
+// mean, standard deviation and confidence interval. The median is taken over every sample. Callers averaging other
+// per-iteration values next to these should skip the same iterations (IsOutlier).
+class SampleStats {
+public:
+    void Add(double sample) {
+        samples.push_back(sample);
+    }
+
+    [[nodiscard]] size_t GetCount() const { return samples.size(); }
+    [[nodiscard]] size_t GetOutlierCount() const { return samples.size() - kept().size(); }
+
+    // Whether the index-th sample added is left out as an outlier
+    [[nodiscard]] bool IsOutlier(size_t index) const {
+        double low, high;
+        fences(low, high);
+        return samples[index] < low || samples[index] > high;
+    }
+
+    [[nodiscard]] double GetMedian() const {
+        return percentile(sorted(), 50.0);
+    }
+
+    [[nodiscard]] double GetMean() const {
+        return mean(kept());
+    }
+
+    // Sample standard deviation, 0 with fewer than two samples
+    [[nodiscard]] double GetStdDev() const {
+        std::vector<double> values = kept();
+        if (values.size() < 2) return 0.0;
+        double average = mean(values);
+        double sumSquares = 0.0;
+        for (double value : values) sumSquares += (value - average) * (value - average);
+        return std::sqrt(sumSquares / (double)(values.size() - 1));
+    }
+
+    // Half width of the 95% confidence interval of the mean (Student's t), 0 with fewer than two samples
+    [[nodiscard]] double GetConfidenceInterval() const {
+        size_t count = kept().size();
+        if (count < 2) return 0.0;
+        return studentT95(count - 1) * GetStdDev() / std::sqrt((double)count);
+    }
+
+    // Whether the confidence interval is within ±relativeWidth of the mean, never with fewer than two samples
+    [[nodiscard]] bool IsWithin(double relativeWidth) const {
+        if (kept().size() < 2) return false;
+        return GetConfidenceInterval() <= relativeWidth * std::abs(GetMean());
+    }
+
+private:
+    // Fewer samples than this have no meaningful quartiles, so nothing is rejected
+    static constexpr size_t minSamplesForOutliers = 4;
+
+    [[nodiscard]] std::vector<double> sorted() const {
+        std::vector<double> values = samples;
+        std::sort(values.begin(), values.end());
+        return values;
+    }
+
+    // Samples outside [low, high] are outliers, nothing is with too few samples for quartiles
+    void fences(double& low, double& high) const {
+        low = -std::numeric_limits<double>::infinity();
+        high = std::numeric_limits<double>::infinity();
+        if (samples.size() < minSamplesForOutliers) return;
+
+        std::vector<double> values = sorted();
+        double q1 = percentile(values, 25.0);
+        double q3 = percentile(values, 75.0);
+        low = q1 - 1.5 * (q3 - q1);
+        high = q3 + 1.5 * (q3 - q1);
+    }
+
+    [[nodiscard]] std::vector<double> kept() const {
+        double low, high;
+        fences(low, high);
+        std::vector<double> values = sorted();
+        values.erase(std::remove_if(values.begin(), values.end(), [&](double value) { return value < low || value > high; }), values.end());
+        return values;
+    }
+
+    static double mean(const std::vector<double>& values) {
+        if (values.empty()) return 0.0;
+        double sum = 0.0;
+        for (double value : values) sum += value;
+        return sum / (double)values.size();
+    }
+
+    // Linear interpolation between the closest ranks of sorted values
+    static double percentile(const std::vector<double>& values, double percent) {
+        if (values.empty()) return 0.0;
+        double rank = percent / 100.0 * (double)(values.size() - 1);
+        size_t below = (size_t)rank;
+        size_t above = std::min(below + 1, values.size() - 1);
+        return values[below] + (rank - (double)below) * (values[above] - values[below]);
+    }
+
+    // Two-sided 95% critical value of Student's t distribution, the normal distribution's past 30 degrees of freedom
+    static double studentT95(size_t degreesOfFreedom) {
+        static constexpr double table[] = {
+            12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+        };
+        if (degreesOfFreedom == 0) return 0.0;
+        if (degreesOfFreedom <= sizeof(table) / sizeof(table[0])) return table[degreesOfFreedom - 1];
+        return 1.960;
+    }
+
+    std::vector<double> samples;
+};
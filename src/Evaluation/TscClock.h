@@ -0,0 +1,126 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define TSC_CLOCK_X86
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define TSC_CLOCK_X86
+#endif
+
+/// Clock that reads the CPU's time stamp counter, a few nanoseconds per now() instead of the tens a
+/// high_resolution_clock call costs, which matters when the latency being measured is itself under 100ns.
+/// Only used when the CPU reports an invariant TSC (constant rate, keeps counting in sleep states, synchronized across
+/// cores) and rdtscp. Otherwise, and on non-x86 CPUs, now() falls back to std::chrono::steady_clock.
+/// The tick rate is calibrated against steady_clock on first use (~20 ms), after that now() is rdtscp plus a
+/// fixed-point multiply.
+/// Meets the standard Clock requirements, so it can be used as Stopwatch<TscClock>.
+struct TscClock {
+    using rep = int64_t;
+    using period = std::nano;
+    using duration = std::chrono::duration<rep, period>;
+    using time_point = std::chrono::time_point<TscClock>;
+    static constexpr bool is_steady = true;
+
+    static time_point now() noexcept {
+        const Calibration& c = calibration();
+#if defined(TSC_CLOCK_X86)
+        if (c.useTsc) {
+            // rdtscp waits for earlier instructions to finish, so the read isn't hoisted above the work being timed
+            unsigned int aux;
+            auto ticks = (int64_t)(__rdtscp(&aux) - c.baseTicks);
+            return time_point(duration(ticksToNs(ticks, c)));
+        }
+#endif
+        return time_point(std::chrono::duration_cast<duration>(std::chrono::steady_clock::now() - c.baseTime));
+    }
+
+    // True if now() reads the TSC, false if it falls back to steady_clock
+    static bool UsesTsc() { return calibration().useTsc; }
+
+    static std::string GetName() {
+        const Calibration& c = calibration();
+        if (!c.useTsc) return "steady_clock (no invariant TSC)";
+        return "TSC (" + std::to_string(1.0 / c.nsPerTick) + " GHz)";
+    }
+
+private:
+    static constexpr int fixedPointShift = 32;
+
+    struct Calibration {
+        bool useTsc = false;
+        uint64_t baseTicks = 0;
+        double nsPerTick = 1.0;
+        int64_t nsPerTickFixed = int64_t(1) << fixedPointShift; // nsPerTick * 2^fixedPointShift
+        std::chrono::steady_clock::time_point baseTime;
+    };
+
+    static rep ticksToNs(int64_t ticks, const Calibration& c) {
+#if defined(__SIZEOF_INT128__)
+        return (rep)(((__int128)ticks * c.nsPerTickFixed) >> fixedPointShift);
+#else
+        return (rep)((double)ticks * c.nsPerTick);
+#endif
+    }
+
+    static const Calibration& calibration() {
+        static const Calibration instance = calibrate();
+        return instance;
+    }
+
+    static Calibration calibrate() {
+        Calibration c;
+        c.baseTime = std::chrono::steady_clock::now();
+#if defined(TSC_CLOCK_X86)
+        if (!hasInvariantTsc()) return c;
+
+        // count ticks over a steady_clock interval, busy-waiting so the thread isn't descheduled in the middle
+        constexpr auto interval = std::chrono::milliseconds(20);
+        unsigned int aux;
+        auto startTime = std::chrono::steady_clock::now();
+        uint64_t startTicks = __rdtscp(&aux);
+        std::chrono::steady_clock::time_point endTime;
+        do {
+            endTime = std::chrono::steady_clock::now();
+        } while (endTime - startTime < interval);
+        uint64_t endTicks = __rdtscp(&aux);
+
+        auto elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+        if (endTicks <= startTicks || elapsedNs <= 0) return c;
+
+        c.useTsc = true;
+        c.nsPerTick = (double)elapsedNs / (double)(endTicks - startTicks);
+        c.nsPerTickFixed = (int64_t)(c.nsPerTick * (double)(int64_t(1) << fixedPointShift));
+        c.baseTicks = endTicks;
+#endif
+        return c;
+    }
+
+#if defined(TSC_CLOCK_X86)
+    static bool hasInvariantTsc() {
+        unsigned int regs[4] = {0, 0, 0, 0};
+        cpuid(0x80000000, regs);
+        if (regs[0] < 0x80000007) return false;
+
+        // CPUID 0x80000001 EDX bit 27: rdtscp, CPUID 0x80000007 EDX bit 8: invariant TSC
+        cpuid(0x80000001, regs);
+        bool hasRdtscp = (regs[3] >> 27) & 1;
+        cpuid(0x80000007, regs);
+        bool invariant = (regs[3] >> 8) & 1;
+        return hasRdtscp && invariant;
+    }
+
+    static void cpuid(unsigned int leaf, unsigned int regs[4]) {
+#if defined(_MSC_VER)
+        __cpuid(reinterpret_cast<int*>(regs), (int)leaf);
+#else
+        __cpuid(leaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+#endif
+};
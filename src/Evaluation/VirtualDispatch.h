@@ -0,0 +1,94 @@
+#pragma once
+
+#include <Job.h>
+#include <IQueue.h>
+
+#include "QueueTraits.h"
+#include "Wait/CpuRelax.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// Implements IQueue<T> by forwarding to a QueueT it owns
+template<typename QueueT, typename T>
+class QueueAdapter final : public IQueue<T> {
+    static_assert(IsQueue<QueueT, T>::value, "QueueT must provide Enqueue, Dequeue, EnqueueBulk and DequeueBulk");
+public:
+    void Enqueue(const T& value) override { queue.Enqueue(value); }
+    bool Dequeue(T& out) override { return queue.Dequeue(out); }
+    void EnqueueBulk(const T* values, size_t count) override { queue.EnqueueBulk(values, count); }
+    size_t DequeueBulk(T* out, size_t max) override { return queue.DequeueBulk(out, max); }
+
+    bool TryEnqueue(const T& value) override {
+        if constexpr (QueueHasTryEnqueue<QueueT>::value) {
+            return queue.TryEnqueue(value);
+        } else {
+            queue.Enqueue(value);
+            return true;
+        }
+    }
+
+    size_t TryEnqueueBulk(const T* values, size_t count) override {
+        if constexpr (QueueHasTryEnqueue<QueueT>::value) {
+            return queue.TryEnqueueBulk(values, count);
+        } else {
+            queue.EnqueueBulk(values, count);
+            return count;
+        }
+    }
+
+    // Forwarded so producers behind the adapter wait for room the same way (e.g. parking) as with the plain queue
+    bool EnqueueWhile(const T& value, const std::atomic<bool>& running) override {
+        if constexpr (QueueHasEnqueueWhile<QueueT>::value) {
+            return queue.EnqueueWhile(value, running);
+        } else {
+            return EnqueueBulkWhile(&value, 1, running) == 1;
+        }
+    }
+
+    size_t EnqueueBulkWhile(const T* values, size_t count, const std::atomic<bool>& running) override {
+        if constexpr (QueueHasEnqueueWhile<QueueT>::value) {
+            return queue.EnqueueBulkWhile(values, count, running);
+        } else {
+            size_t enqueued = 0;
+            while (enqueued < count && running.load(std::memory_order_relaxed)) {
+                size_t added = TryEnqueueBulk(values + enqueued, count - enqueued);
+                if (added == 0) cpuRelax();
+                enqueued += added;
+            }
+            return enqueued;
+        }
+    }
+
+private:
+    QueueT queue;
+};
+
+// Benchmarks QueueT called through IQueue<Job*>'s virtual functions, the way every queue was called before job
+// systems used the concrete type. Comparing it with plain QueueT shows what the indirect calls cost.
+// The adapter lives behind an IQueue pointer, so calls go through the vtable as they would for a queue picked at runtime.
+template<typename QueueT>
+class VirtualDispatch {
+public:
+    static std::string GetName() { return QueueT::GetName() + " [Virtual Dispatch]"; }
+
+    static constexpr int maxProducers = QueueMaxProducers<QueueT>::value;
+    static constexpr int maxConsumers = QueueMaxConsumers<QueueT>::value;
+    static constexpr bool isIntrusive = QueueIsIntrusive<QueueT>::value;
+
+    VirtualDispatch() : queue(std::make_unique<QueueAdapter<QueueT, Job*>>()) { }
+
+    void Enqueue(Job* const& value) { queue->Enqueue(value); }
+    bool Dequeue(Job*& out) { return queue->Dequeue(out); }
+    void EnqueueBulk(Job* const* values, size_t count) { queue->EnqueueBulk(values, count); }
+    size_t DequeueBulk(Job** out, size_t max) { return queue->DequeueBulk(out, max); }
+    bool TryEnqueue(Job* const& value) { return queue->TryEnqueue(value); }
+    size_t TryEnqueueBulk(Job* const* values, size_t count) { return queue->TryEnqueueBulk(values, count); }
+    bool EnqueueWhile(Job* const& value, const std::atomic<bool>& running) { return queue->EnqueueWhile(value, running); }
+    size_t EnqueueBulkWhile(Job* const* values, size_t count, const std::atomic<bool>& running) { return queue->EnqueueBulkWhile(values, count, running); }
+
+private:
+    std::unique_ptr<IQueue<Job*>> queue;
+};
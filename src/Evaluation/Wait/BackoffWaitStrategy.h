@@ -0,0 +1,37 @@
+#pragma once
+
+#include "CpuRelax.h"
+
+#include <string>
+
+/// Consumers spin with pause instructions between retries, doubling the number of pauses every time the queue is
+/// still empty. Keeps a consumer off the queue's cache lines while it is idle without giving up its core.
+class BackoffWaitStrategy {
+public:
+    static std::string GetName() { return "Exponential Backoff"; }
+
+    static constexpr bool blocks = false;
+
+    class Waiter {
+    public:
+        explicit Waiter(BackoffWaitStrategy&) { }
+
+        void Reset() { pauses = 1; }
+        void PrepareWait() { }
+        void CancelWait() { }
+
+        void CommitWait() {
+            for (unsigned i = 0; i < pauses; i++) {
+                cpuRelax();
+            }
+            if (pauses < maxPauses) pauses *= 2;
+        }
+
+    private:
+        static constexpr unsigned maxPauses = 1024;
+        unsigned pauses = 1;
+    };
+
+    void Notify() { }
+    void NotifyAll() { }
+};
\ No newline at end of file
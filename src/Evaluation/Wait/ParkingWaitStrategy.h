@@ -0,0 +1,116 @@
+#pragma once
+
+#include "CpuRelax.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+/// Consumers spin briefly, then sleep in the kernel until a producer enqueues something. Uses an eventcount
+/// (https://www.1024cores.net/home/lock-free-algorithms/eventcounts) so producers only pay for a wake-up when a
+/// consumer is actually asleep, and a consumer can't miss an enqueue that races with it going to sleep:
+///   consumer: PrepareWait (register + read epoch), re-check the queue, then CancelWait or CommitWait (sleep until the
+///             epoch changes)
+///   producer: enqueue, then Notify (if anyone is registered, bump the epoch and wake one)
+/// Sleeping uses a futex on Linux and a condition variable elsewhere.
+class ParkingWaitStrategy {
+public:
+    static std::string GetName() { return "Park (Eventcount)"; }
+
+    static constexpr bool blocks = true;
+
+    class Waiter {
+    public:
+        explicit Waiter(ParkingWaitStrategy& strategy) : strategy(strategy) { }
+
+        void Reset() { idleRounds = 0; }
+
+        void PrepareWait() {
+            if (idleRounds < spinRounds) return;
+            strategy.waiters.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            key = strategy.epoch.load(std::memory_order_seq_cst);
+            registered = true;
+        }
+
+        void CancelWait() {
+            if (!registered) return;
+            strategy.waiters.fetch_sub(1, std::memory_order_relaxed);
+            registered = false;
+        }
+
+        void CommitWait() {
+            if (!registered) {
+                idleRounds++;
+                cpuRelax();
+                return;
+            }
+            strategy.sleep(key);
+            strategy.waiters.fetch_sub(1, std::memory_order_relaxed);
+            registered = false;
+        }
+
+    private:
+        // Idle rounds spent spinning before a consumer goes to sleep
+        static constexpr unsigned spinRounds = 128;
+
+        ParkingWaitStrategy& strategy;
+        unsigned idleRounds = 0;
+        uint32_t key = 0;
+        bool registered = false;
+    };
+
+    // Called by producers after every enqueue. Costs a fence and a load while no consumer is asleep.
+    void Notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) == 0) return;
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        wake(1);
+    }
+
+    void NotifyAll() {
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        wake(INT32_MAX);
+    }
+
+private:
+#if defined(__linux__)
+    // Sleeps unless the epoch has already moved on from key
+    void sleep(uint32_t key) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch), FUTEX_WAIT_PRIVATE, key, nullptr, nullptr, 0);
+    }
+
+    void wake(int32_t count) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+    }
+#else
+    void sleep(uint32_t key) {
+        std::unique_lock lock(mutex);
+        cv.wait(lock, [&] { return epoch.load() != key; });
+    }
+
+    void wake(int32_t count) {
+        // taking the lock orders the epoch bump before a sleeper's check
+        { std::lock_guard lock(mutex); }
+        if (count == 1) cv.notify_one();
+        else cv.notify_all();
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+#endif
+
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex needs a plain 32-bit word");
+
+    std::atomic<uint32_t> epoch{0};
+    std::atomic<uint32_t> waiters{0};
+};
\ No newline at end of file
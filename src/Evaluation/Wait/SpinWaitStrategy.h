@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+/// Consumers retry the queue immediately. Lowest wake-up latency, but an idle consumer burns a full core.
+class SpinWaitStrategy {
+public:
+    static std::string GetName() { return "Spin"; }
+
+    // Whether consumers must announce a wait and re-check the queue before CommitWait (see ParkingWaitStrategy)
+    static constexpr bool blocks = false;
+
+    class Waiter {
+    public:
+        explicit Waiter(SpinWaitStrategy&) { }
+
+        void Reset() { }
+        void PrepareWait() { }
+        void CancelWait() { }
+        void CommitWait() { }
+    };
+
+    void Notify() { }
+    void NotifyAll() { }
+};
\ No newline at end of file
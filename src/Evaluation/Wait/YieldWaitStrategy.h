@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <thread>
+
+/// Consumers give the rest of their time slice to other runnable threads between retries. Helps when threads
+/// outnumber cores, but an idle consumer still returns to the run queue immediately.
+class YieldWaitStrategy {
+public:
+    static std::string GetName() { return "Yield"; }
+
+    static constexpr bool blocks = false;
+
+    class Waiter {
+    public:
+        explicit Waiter(YieldWaitStrategy&) { }
+
+        void Reset() { }
+        void PrepareWait() { }
+        void CancelWait() { }
+        void CommitWait() { std::this_thread::yield(); }
+    };
+
+    void Notify() { }
+    void NotifyAll() { }
+};
\ No newline at end of file
@@ -0,0 +1,302 @@
+#pragma once
+
+#include <Job.h>
+
+#include "JobSystem.h"
+#include "QueueTraits.h"
+#include "Backpressure.h"
+#include "QueueHandle.h"
+#include "Arrivals.h"
+#include "JobEnvelope.h"
+#include "LatencyHistogram.h"
+#include "WorkerPool.h"
+#include "Completion/PerConsumerCompletion.h"
+#include "../Queues/ChaseLevDeque.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <type_traits>
+
+// Benchmarks the work-stealing scheduler with InboxQueueT as each consumer's inbox, e.g. in runThroughput's queue list
+template<typename InboxQueueT>
+struct WorkStealing {
+    static std::string GetName() { return "Work Stealing (" + InboxQueueT::GetName() + " inboxes)"; }
+
+    // Every producer enqueues into every inbox, but each inbox has a single consumer
+    static constexpr int maxProducers = QueueMaxProducers<InboxQueueT>::value;
+    static constexpr bool isIntrusive = QueueIsIntrusive<InboxQueueT>::value;
+};
+
+template<typename QueueT>
+struct IsWorkStealing : std::false_type { };
+template<typename InboxQueueT>
+struct IsWorkStealing<WorkStealing<InboxQueueT>> : std::true_type { };
+
+// Scheduler where each consumer owns a Chase-Lev deque instead of all threads sharing one queue.
+// Producers round-robin jobs into per-consumer inboxes, a consumer moves jobs from its inbox into its deque and works
+// from the bottom of it, and when both are empty it steals from the top of a random other consumer's deque.
+template<typename InboxQueueT, bool measureLatency>
+class WorkStealingJobSystem {
+    static_assert(IsQueue<InboxQueueT, Job*>::value, "InboxQueueT must provide Enqueue, Dequeue, EnqueueBulk and DequeueBulk for Job*");
+public:
+    // inboxCapacity sizes inboxes with a runtime capacity, 0 keeps their default
+    explicit WorkStealingJobSystem(const std::vector<std::unique_ptr<Job>>& jobs, size_t inboxCapacity = 0)
+        : availableJobs(jobs), inboxCapacity(inboxCapacity) { }
+
+    ~WorkStealingJobSystem() {
+        if (running) {
+            StopWorkers();
+        }
+    }
+
+    // batchSize > 1 makes producers fill inboxes with EnqueueBulk, arrivalRate paces the producers (see Arrivals.h)
+    // Returns once every worker is awake, they wait for ReleaseWorkers before touching the queue
+    void StartWorkers(int numProducers, int numConsumers, size_t batchSize = 1, ArrivalRate arrivalRate = {}) {
+        running = true;
+        completion.Reset(numConsumers);
+        numSteals = 0;
+        numFullEnqueues = 0;
+        this->batchSize = std::max<size_t>(batchSize, 1);
+        this->numProducers = numProducers;
+        this->arrivalRate = arrivalRate;
+        if constexpr (measureLatency) {
+            // histograms are allocated here so recording inside the run never allocates
+            if (!latencies) latencies = std::make_unique<EnvelopeLatencies>();
+            latencies->Reset();
+            consumerLatencies.resize(numConsumers);
+            for (auto& histograms : consumerLatencies) {
+                if (!histograms) histograms = std::make_unique<EnvelopeLatencies>();
+                histograms->Reset();
+            }
+            // rings are only ever added, envelopes left in an inbox by an earlier run must stay valid
+            while (envelopeRings.size() < (size_t)numProducers) {
+                envelopeRings.push_back(std::make_unique<JobEnvelopeRing>((uint32_t)envelopeRings.size()));
+            }
+        }
+
+        workers.clear();
+        for (int i = 0; i < numConsumers; i++) {
+            workers.push_back(std::make_unique<Worker>(inboxCapacity));
+        }
+
+        // producers run on the pool's first numProducers workers, consumers on the ones after them
+        pool.Start(numProducers + numConsumers, [this, numProducers](int index) {
+            if (index < numProducers) producerEntry(index);
+            else consumerEntry(index - numProducers);
+        });
+    }
+
+    // Lets the workers started by StartWorkers begin producing and consuming. Split from StartWorkers so the caller can
+    // take its baselines once every worker is already awake.
+    void ReleaseWorkers() {
+        arrivalStart = TscClock::now();
+        pool.Release();
+    }
+
+    void StopWorkers() {
+        running = false;
+        completion.Cancel();
+        pool.Join();
+
+        if constexpr (measureLatency) {
+            for (auto& histograms : consumerLatencies) {
+                latencies->Merge(*histograms);
+            }
+        }
+    }
+
+    void WaitForJobs(size_t numJobs) {
+        completion.WaitFor(numJobs);
+    }
+
+    // Exact once the workers are stopped, may lag behind the consumers while they are running
+    [[nodiscard]] size_t GetCompletedJobCount() const {
+        return completion.GetCount();
+    }
+
+    // Number of jobs consumers took from another consumer's deque
+    [[nodiscard]] size_t GetStealCount() const {
+        return numSteals.load();
+    }
+
+    // Number of enqueue calls that found a bounded inbox full, exact once the workers are stopped
+    [[nodiscard]] size_t GetFullEnqueueCount() const {
+        return numFullEnqueues.load();
+    }
+
+    // Inboxes are always waited on when full, so nothing is dropped
+    [[nodiscard]] size_t GetDroppedCount() const {
+        return 0;
+    }
+
+    // Latency runs only, every consumer's latencies merged by StopWorkers
+    [[nodiscard]] const LatencyHistogram& GetLatencies() const {
+        return latencies->raw;
+    }
+
+    // Latency runs only, latencies from when each job was due rather than enqueued (see EnvelopeLatencies)
+    [[nodiscard]] const LatencyHistogram& GetCorrectedLatencies() const {
+        return latencies->corrected;
+    }
+
+private:
+    // Jobs moved from the inbox to the deque at a time
+    static constexpr size_t inboxDrainSize = 32;
+
+    struct Worker {
+        explicit Worker(size_t inboxCapacity) : inbox(makeQueue<InboxQueueT>(inboxCapacity)) { }
+
+        InboxQueueT inbox;
+        ChaseLevDeque<Job*> deque;
+    };
+
+    void producerEntry(int index) {
+        size_t nextJobType = index % availableJobs.size();
+        if constexpr (QueueIsIntrusive<InboxQueueT>::value) {
+            // spread producers over the pool so they don't race each other to claim the same jobs
+            nextJobType = index * availableJobs.size() / numProducers;
+        }
+        size_t nextWorker = index % workers.size();
+        EnqueueStats stats;
+        // one handle per inbox, so each inbox gets this producer's token
+        std::vector<std::unique_ptr<ProducerHandle<InboxQueueT>>> inboxes;
+        for (auto& worker : workers) {
+            inboxes.push_back(std::make_unique<ProducerHandle<InboxQueueT>>(worker->inbox));
+        }
+
+        ArrivalSchedule arrivals(arrivalRate, numProducers, index, arrivalStart);
+
+        std::vector<Job*> batch(batchSize);
+        while (running) {
+            size_t count = 0;
+            while (count < batch.size()) {
+                TscClock::time_point due = TscClock::time_point::max();
+                if (arrivals.IsOpenLoop()) due = arrivals.WaitForNext(running);
+                Job* jobToInsert = takeNextJob(nextJobType);
+                if (jobToInsert == nullptr) break;
+                if constexpr (measureLatency) {
+                    // latency runs enqueue an envelope per job so each enqueue keeps its own timestamp
+                    jobToInsert = envelopeRings[index]->Acquire(jobToInsert, running, due);
+                    if (jobToInsert == nullptr) break;
+                }
+                batch[count++] = jobToInsert;
+            }
+            if (count == 0) continue;
+            if constexpr (measureLatency) {
+                auto enqueueTime = TscClock::now();
+                for (size_t i = 0; i < count; i++) static_cast<JobEnvelope*>(batch[i])->Stamp(enqueueTime);
+            }
+
+            size_t enqueued = enqueueJobs<FullQueuePolicy::Block>(*inboxes[nextWorker], batch.data(), count, running, stats);
+            if constexpr (measureLatency) {
+                // envelopes that weren't enqueued because the run stopped while the inbox was full go back to their ring
+                for (size_t i = enqueued; i < count; i++) static_cast<JobEnvelope*>(batch[i])->Release();
+            }
+            nextWorker = (nextWorker + 1) % workers.size();
+        }
+
+        numFullEnqueues += stats.fullEnqueues;
+    }
+
+    // Returns the next job to enqueue. Intrusive inboxes link the job itself, so jobs that are still in an inbox are
+    // skipped (unless it is a latency run, where the inbox links the envelope instead), returns nullptr if the workers
+    // are stopped while waiting for one.
+    Job* takeNextJob(size_t& nextJobType) {
+        while (true) {
+            Job* job = availableJobs[nextJobType].get();
+            nextJobType = (nextJobType + 1) % availableJobs.size();
+
+            if constexpr (!QueueIsIntrusive<InboxQueueT>::value || measureLatency) {
+                return job;
+            } else {
+                if (job->TryLink()) return job;
+                if (!running) return nullptr;
+            }
+        }
+    }
+
+    void consumerEntry(int index) {
+        EnvelopeLatencies* latencies = measureLatency ? consumerLatencies[index].get() : nullptr;
+
+        Worker& self = *workers[index];
+        ConsumerHandle<InboxQueueT> inbox(self.inbox);
+        std::minstd_rand rng(index + 1);
+        size_t steals = 0;
+        PerConsumerCompletion::Counter completed(completion, index);
+
+        std::vector<Job*> drained(inboxDrainSize);
+        Job* job;
+        while (running) {
+            if (!self.deque.PopBottom(job)) {
+                size_t count = inbox.DequeueBulk(drained.data(), drained.size());
+                if (count > 0) {
+                    // keep the first one to run now, the rest become stealable
+                    for (size_t i = count - 1; i > 0; i--) {
+                        self.deque.PushBottom(drained[i]);
+                    }
+                    job = drained[0];
+                }
+                else if (workers.size() > 1) {
+                    size_t victim = rng() % (workers.size() - 1);
+                    if (victim >= (size_t)index) victim++;
+                    if (!workers[victim]->deque.Steal(job)) {
+                        completed.Flush();
+                        continue;
+                    }
+                    steals++;
+                }
+                else {
+                    completed.Flush();
+                    continue;
+                }
+            }
+
+            if constexpr (measureLatency) {
+                auto dequeueTime = TscClock::now();
+                latencies->Record(*static_cast<JobEnvelope*>(job), dequeueTime);
+            }
+
+            job->operator()();
+            completed.Add(1);
+        }
+
+        completed.Flush();
+        numSteals += steals;
+    }
+
+private:
+    // Latency runs only, one per producer. Declared before the workers so they outlive anything still in an inbox.
+    std::vector<std::unique_ptr<JobEnvelopeRing>> envelopeRings;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    const std::vector<std::unique_ptr<Job>>& availableJobs;
+    size_t inboxCapacity;
+
+    size_t batchSize = 1;
+    int numProducers = 1;
+    ArrivalRate arrivalRate;
+    TscClock::time_point arrivalStart;
+
+    std::atomic<bool> running = false;
+    std::atomic<size_t> numSteals = 0;
+    std::atomic<size_t> numFullEnqueues = 0;
+    PerConsumerCompletion completion;
+
+    WorkerPool& pool = WorkerPool::Shared();
+
+    // Latency runs only, each consumer records into its own histogram
+    std::vector<std::unique_ptr<EnvelopeLatencies>> consumerLatencies;
+    std::unique_ptr<EnvelopeLatencies> latencies;
+};
+
+// Runs WorkStealing<InboxQueueT> on the work-stealing scheduler
+template<typename InboxQueueT, bool measureLatency>
+struct JobSystemFor<WorkStealing<InboxQueueT>, measureLatency> {
+    using type = WorkStealingJobSystem<InboxQueueT, measureLatency>;
+};
\ No newline at end of file
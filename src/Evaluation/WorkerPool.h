@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Wait/CpuRelax.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// The threads job systems run their producers and consumers on. Spawning and joining threads for every run puts thread
+// creation, stack faulting and the scheduler's first placement of each thread into the samples, so workers are started
+// the first time a run needs them and parked between runs. Each run re-targets the first count workers at its task in
+// two phases: Start returns once all of them have woken up and checked in, and they only begin the task once Release
+// is called, so the caller can take its baselines (stopwatch, CPU time) in between. Checked in workers spin rather than
+// block until then, so Release is a single store and the wake-up doesn't land inside the measured time. Join returns
+// once all of them have returned from the task.
+// One run at a time, Start and Join are called by the thread driving the benchmark.
+class WorkerPool {
+public:
+    // Intentionally leaked: parked workers are never joined, so nothing waits on them at exit, and thread_local state
+    // they hold (e.g. reclaimer records) isn't torn down after the statics it refers to.
+    static WorkerPool& Shared() {
+        static auto* instance = new WorkerPool();
+        return *instance;
+    }
+
+    WorkerPool() = default;
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Hands task(0) .. task(count - 1) to a worker each, starting more workers if there are fewer than count. Returns
+    // once every one of them is awake and waiting for Release.
+    void Start(int count, std::function<void(int)> task) {
+        std::unique_lock lock(mutex);
+        while (workers.size() < (size_t)count) {
+            workers.emplace_back([this, index = (int)workers.size()] { workerLoop(index); });
+        }
+
+        this->task = std::move(task);
+        activeCount = count;
+        started = 0;
+        remaining = count;
+        generation++;
+        wake.notify_all();
+        done.wait(lock, [&] { return started == activeCount; });
+    }
+
+    // Lets the workers checked in by Start begin the task, calling it again does nothing
+    void Release() {
+        releasedGeneration.store(generation, std::memory_order_release);
+    }
+
+    // Waits until every worker of the current run has returned from its task, releasing them first if Release wasn't
+    // called
+    void Join() {
+        Release();
+        std::unique_lock lock(mutex);
+        done.wait(lock, [&] { return remaining == 0; });
+        task = nullptr;
+    }
+
+private:
+    void workerLoop(int index) {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock lock(mutex);
+                wake.wait(lock, [&] { return generation != seen && index < activeCount; });
+                seen = generation;
+                if (++started == activeCount) done.notify_all();
+            }
+            while (releasedGeneration.load(std::memory_order_acquire) != seen) cpuRelax();
+
+            // task isn't replaced until every worker running it has finished
+            task(index);
+
+            std::lock_guard lock(mutex);
+            if (--remaining == 0) done.notify_all();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable wake; // workers waiting for the next run
+    std::condition_variable done; // Start and Join waiting for the workers
+
+    std::vector<std::thread> workers;
+    std::function<void(int)> task;
+    int activeCount = 0;
+    int started = 0;
+    int remaining = 0;
+    uint64_t generation = 0; // only changed by Start, so Release can read it without the mutex
+    std::atomic<uint64_t> releasedGeneration{0}; // the last run Release was called for
+};
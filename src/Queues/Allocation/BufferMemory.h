@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+/// Allocates ring buffer storage from the global heap on normal pages, aligned to a cache line
+class HeapBufferMemory {
+public:
+    static std::string GetName() { return "Heap"; }
+
+    static void* Allocate(size_t bytes) {
+        return operator new[](bytes, std::align_val_t(std::hardware_destructive_interference_size));
+    }
+
+    static void Free(void* memory, size_t) {
+        operator delete[](memory, std::align_val_t(std::hardware_destructive_interference_size));
+    }
+};
+
+/// Places ring buffer storage on 2MB huge pages, so even a ring of millions of cells only needs a few TLB entries.
+/// Tries explicit huge pages first (mmap with MAP_HUGETLB, which needs pages reserved through vm.nr_hugepages), then
+/// transparent huge pages (madvise(MADV_HUGEPAGE) on a 2MB aligned mapping, which the kernel may or may not honour).
+/// Other platforms use the heap.
+class HugePageBufferMemory {
+public:
+    static std::string GetName() { return "Huge Pages"; }
+
+    static constexpr size_t hugePageSize = 2 * 1024 * 1024;
+
+    static void* Allocate(size_t bytes) {
+#if defined(__linux__)
+        size_t length = roundUp(bytes);
+#if defined(MAP_HUGETLB)
+        void* memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED) return memory;
+#endif
+        // map an extra huge page so the start can be moved to a 2MB boundary, then give back what is left over
+        auto* mapped = static_cast<char*>(mmap(nullptr, length + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (mapped == MAP_FAILED) throw std::bad_alloc();
+        auto address = reinterpret_cast<uintptr_t>(mapped);
+        auto* aligned = reinterpret_cast<char*>((address + hugePageSize - 1) & ~(uintptr_t)(hugePageSize - 1));
+        if (aligned != mapped) munmap(mapped, aligned - mapped);
+        munmap(aligned + length, mapped + hugePageSize - aligned);
+#if defined(MADV_HUGEPAGE)
+        madvise(aligned, length, MADV_HUGEPAGE);
+#endif
+        return aligned;
+#else
+        return HeapBufferMemory::Allocate(bytes);
+#endif
+    }
+
+    static void Free(void* memory, size_t bytes) {
+#if defined(__linux__)
+        munmap(memory, roundUp(bytes));
+#else
+        HeapBufferMemory::Free(memory, bytes);
+#endif
+    }
+
+private:
+    static size_t roundUp(size_t bytes) {
+        return (bytes + hugePageSize - 1) & ~(hugePageSize - 1);
+    }
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <utility>
+
+/// Allocates every node from the global heap with new/delete
+class HeapNodeAllocator {
+public:
+    static std::string GetName() { return "Heap"; }
+
+    template<typename U, typename... Args>
+    static U* New(Args&&... args) {
+        return new U(std::forward<Args>(args)...);
+    }
+
+    template<typename U>
+    static void Delete(U* ptr) {
+        delete ptr;
+    }
+};
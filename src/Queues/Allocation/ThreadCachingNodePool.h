@@ -0,0 +1,200 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <utility>
+
+/// Recycles fixed-size nodes without touching malloc in the steady state (Bonwick & Adams 2001,
+/// https://www.usenix.org/legacy/event/usenix01/full_papers/bonwick/bonwick.pdf).
+/// Each thread allocates from and frees into its own magazine (a small stack of free blocks). When a thread's
+/// magazine runs empty or full it is swapped for another one through a lock-free depot shared by all threads, so a
+/// producer that only allocates and a consumer that only frees hand nodes to each other a magazine at a time.
+/// Memory is only taken from the heap in slabs, and is never given back while the process runs.
+class ThreadCachingNodePool {
+public:
+    static std::string GetName() { return "Node Pool"; }
+
+    template<typename U, typename... Args>
+    static U* New(Args&&... args) {
+        void* block = pool<blockSize<U>(), alignof(U)>().Allocate();
+        return new(block) U(std::forward<Args>(args)...);
+    }
+
+    template<typename U>
+    static void Delete(U* ptr) {
+        ptr->~U();
+        pool<blockSize<U>(), alignof(U)>().Free(ptr);
+    }
+
+private:
+    static constexpr size_t magazineSize = 64;
+    static constexpr size_t blocksPerSlab = 1024;
+
+    // Free blocks are threaded through their own first bytes, so a block must fit a pointer
+    template<typename U>
+    static constexpr size_t blockSize() {
+        size_t size = sizeof(U) < sizeof(void*) ? sizeof(void*) : sizeof(U);
+        return (size + alignof(U) - 1) / alignof(U) * alignof(U);
+    }
+
+    struct Magazine {
+        std::atomic<Magazine*> next{nullptr};
+        size_t count = 0;
+        void* blocks[magazineSize];
+    };
+
+    // Treiber stack of magazines. Magazines are never freed, and the top pointer carries a 16-bit tag in its unused
+    // upper bits (user space addresses fit in 48 bits on x86-64 and AArch64) to avoid ABA on pop.
+    class MagazineStack {
+        static_assert(sizeof(void*) == 8, "MagazineStack packs a tag into the upper 16 bits of a 64-bit pointer");
+    public:
+        void Push(Magazine* magazine) {
+            uint64_t top = head.load(std::memory_order_relaxed);
+            do {
+                magazine->next.store(unpack(top), std::memory_order_relaxed);
+            } while (!head.compare_exchange_weak(top, pack(magazine, tag(top) + 1), std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        Magazine* Pop() {
+            uint64_t top = head.load(std::memory_order_acquire);
+            while (unpack(top) != nullptr) {
+                Magazine* magazine = unpack(top);
+                if (head.compare_exchange_weak(top, pack(magazine->next.load(std::memory_order_relaxed), tag(top) + 1), std::memory_order_acquire, std::memory_order_acquire)) {
+                    return magazine;
+                }
+            }
+            return nullptr;
+        }
+
+    private:
+        static constexpr uint64_t pointerMask = (uint64_t(1) << 48) - 1;
+
+        static Magazine* unpack(uint64_t value) { return reinterpret_cast<Magazine*>(value & pointerMask); }
+        static uint64_t tag(uint64_t value) { return value >> 48; }
+        static uint64_t pack(Magazine* magazine, uint64_t tag) { return (tag << 48) | (reinterpret_cast<uint64_t>(magazine) & pointerMask); }
+
+        std::atomic<uint64_t> head{0};
+    };
+
+    template<size_t size, size_t alignment>
+    class BlockPool {
+    public:
+        void* Allocate() {
+            if (cacheDestroyed) {
+                // thread is exiting, nothing to cache into
+                return operator new(size, std::align_val_t(alignment));
+            }
+            return localCache().Allocate(*this);
+        }
+
+        void Free(void* block) {
+            if (cacheDestroyed) {
+                pushOrphans(block, block);
+                return;
+            }
+            localCache().Free(*this, block);
+        }
+
+    private:
+        struct ThreadCache {
+            Magazine* loaded = nullptr;
+            void* overflow = nullptr; // free blocks linked through their first bytes
+
+            ~ThreadCache() {
+                BlockPool& owner = pool<size, alignment>();
+                if (loaded != nullptr) {
+                    if (loaded->count > 0) owner.fullMagazines.Push(loaded);
+                    else owner.emptyMagazines.Push(loaded);
+                }
+                if (overflow != nullptr) {
+                    void* last = overflow;
+                    while (nextOf(last) != nullptr) last = nextOf(last);
+                    owner.pushOrphans(overflow, last);
+                }
+                cacheDestroyed = true;
+            }
+
+            void* Allocate(BlockPool& owner) {
+                if (loaded != nullptr && loaded->count > 0) {
+                    return loaded->blocks[--loaded->count];
+                }
+                if (overflow == nullptr) {
+                    // trade the empty magazine for a full one from the depot
+                    if (Magazine* full = owner.fullMagazines.Pop()) {
+                        if (loaded != nullptr) owner.emptyMagazines.Push(loaded);
+                        loaded = full;
+                        return loaded->blocks[--loaded->count];
+                    }
+                    overflow = owner.orphans.exchange(nullptr, std::memory_order_acquire);
+                    if (overflow == nullptr) {
+                        overflow = allocateSlab();
+                    }
+                }
+                void* block = overflow;
+                overflow = nextOf(block);
+                return block;
+            }
+
+            void Free(BlockPool& owner, void* block) {
+                if (loaded == nullptr) {
+                    loaded = owner.takeEmptyMagazine();
+                }
+                else if (loaded->count == magazineSize) {
+                    // hand the full magazine to the depot for a thread that is allocating
+                    owner.fullMagazines.Push(loaded);
+                    loaded = owner.takeEmptyMagazine();
+                }
+                loaded->blocks[loaded->count++] = block;
+            }
+        };
+
+        static void*& nextOf(void* block) {
+            return *static_cast<void**>(block);
+        }
+
+        // Allocates a slab from the heap and returns its blocks as a linked list
+        static void* allocateSlab() {
+            auto* slab = static_cast<std::byte*>(operator new(size * blocksPerSlab, std::align_val_t(alignment)));
+            for (size_t i = 0; i + 1 < blocksPerSlab; i++) {
+                nextOf(slab + i * size) = slab + (i + 1) * size;
+            }
+            nextOf(slab + (blocksPerSlab - 1) * size) = nullptr;
+            return slab;
+        }
+
+        Magazine* takeEmptyMagazine() {
+            Magazine* magazine = emptyMagazines.Pop();
+            return magazine != nullptr ? magazine : new Magazine();
+        }
+
+        // Pushes the linked list first..last onto the orphan list. Orphans are only ever taken all at once with an
+        // exchange, so this needs no ABA protection.
+        void pushOrphans(void* first, void* last) {
+            void* top = orphans.load(std::memory_order_relaxed);
+            do {
+                nextOf(last) = top;
+            } while (!orphans.compare_exchange_weak(top, first, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        static ThreadCache& localCache() {
+            thread_local ThreadCache cache;
+            return cache;
+        }
+
+        inline static thread_local bool cacheDestroyed = false;
+
+        MagazineStack fullMagazines;
+        MagazineStack emptyMagazines;
+        std::atomic<void*> orphans{nullptr};
+    };
+
+    // Pools are intentionally leaked so nodes freed during static destruction (e.g. by a reclaimer) still have a pool
+    template<size_t size, size_t alignment>
+    static BlockPool<size, alignment>& pool() {
+        static auto* instance = new BlockPool<size, alignment>();
+        return *instance;
+    }
+};
@@ -1,67 +1,145 @@
 #pragma once
 
-#include <IQueue.h>
 #include <Job.h>
 
+#include "ProducerParking.h"
+#include "Allocation/BufferMemory.h"
+#include "Layout/CellLayout.h"
+
 #include <atomic>
 #include <cassert>
+#include <string>
+#include <type_traits>
+
+// Pass as bufferSize to choose the capacity when the queue is constructed instead
+inline constexpr size_t runtimeCapacity = 0;
 
-template<class T, size_t bufferSize>
-class BoundedCircularBufferQueue : public IQueue<T> {
+// MemoryT decides where the cells are allocated (see Allocation/BufferMemory.h), LayoutT how they are laid out in it
+// (see Layout/CellLayout.h)
+template<class T, size_t bufferSize, typename MemoryT = HeapBufferMemory, typename LayoutT = PackedCellLayout>
+class BoundedCircularBufferQueue {
     // Checks if bufferSize is a power of two, if it isn't prints message
     static_assert((bufferSize & (bufferSize - 1)) == 0 && "bufferSize must be a power of two");
 public:
-    static std::string GetName() { return "Circular Buffer Queue (" + std::to_string(bufferSize) + " cells)"; }
+    // Capacity of a runtimeCapacity queue constructed without one
+    static constexpr size_t defaultCapacity = 1024;
+
+    static std::string GetName() {
+        std::string name = "Circular Buffer Queue (";
+        name += bufferSize == runtimeCapacity ? "Runtime Capacity" : std::to_string(bufferSize) + " cells";
+        if constexpr (!std::is_same_v<MemoryT, HeapBufferMemory>) name += ", " + MemoryT::GetName();
+        if constexpr (!std::is_same_v<LayoutT, PackedCellLayout>) name += ", " + LayoutT::GetName() + " Cells";
+        return name + ")";
+    }
 
-    // Constructor and Deconstructor
-    BoundedCircularBufferQueue();
+    // Constructor and Deconstructor, runtimeCapacity queues can be given a capacity, which is rounded up to a power of two
+    BoundedCircularBufferQueue() : BoundedCircularBufferQueue(bufferSize == runtimeCapacity ? defaultCapacity : bufferSize, 0) { }
+    template<size_t size = bufferSize, std::enable_if_t<size == runtimeCapacity, int> = 0>
+    explicit BoundedCircularBufferQueue(size_t capacity) : BoundedCircularBufferQueue(roundUpToPowerOfTwo(capacity), 0) { }
     ~BoundedCircularBufferQueue();
 
-    // Enqueue and Dequeue declaration
-    void Enqueue(const T& value) override;
-    bool Dequeue(T& out) override;
+    [[nodiscard]] size_t GetCapacity() const { return bufferMask + 1; }
+
+    // Enqueue and Dequeue declaration, Enqueue waits for a free cell while the buffer is full (spins, then parks)
+    void Enqueue(const T& value);
+    bool Dequeue(T& out);
+
+    // Bulk Enqueue and Dequeue declaration, EnqueueBulk waits until every value is enqueued
+    void EnqueueBulk(const T* values, size_t count);
+    size_t DequeueBulk(T* out, size_t max);
+
+    // Never wait: TryEnqueue returns false if the buffer was full, TryEnqueueBulk returns how many of the values (from
+    // the front) were enqueued before it was
+    bool TryEnqueue(const T& value);
+    size_t TryEnqueueBulk(const T* values, size_t count);
+
+    // Wait like Enqueue/EnqueueBulk, but give up once running is false, so producers can be stopped while the buffer
+    // is full. EnqueueWhile returns false if it gave up, EnqueueBulkWhile the number of values enqueued.
+    bool EnqueueWhile(const T& value, const std::atomic<bool>& running);
+    size_t EnqueueBulkWhile(const T* values, size_t count, const std::atomic<bool>& running);
 
 private:
+    BoundedCircularBufferQueue(size_t capacity, int);
+
+    static size_t roundUpToPowerOfTwo(size_t capacity) {
+        size_t rounded = 2;
+        while (rounded < capacity) rounded <<= 1;
+        return rounded;
+    }
+
+    static unsigned log2(size_t powerOfTwo) {
+        unsigned result = 0;
+        while (powerOfTwo > 1) {
+            powerOfTwo >>= 1;
+            result++;
+        }
+        return result;
+    }
+
     // Structure for each cell
     struct Cell {
         std::atomic<size_t> sequence;
         T data;
     };
+    using Slot = typename LayoutT::template Slot<Cell>;
+
+    // Cell that holds position pos
+    Cell& cellAt(size_t pos) {
+        return buffer[LayoutT::template Index<Cell>(pos, bufferMask, capacityLog2)].cell;
+    }
 
     const size_t bufferMask;
-    Cell* const buffer;
+    const unsigned capacityLog2;
+    Slot* const buffer;
 
     // Padding to avoid false sharing (https://en.wikipedia.org/wiki/False_sharing)
     alignas(std::hardware_destructive_interference_size) std::atomic<size_t> enqueuePos{0};
     alignas(std::hardware_destructive_interference_size) std::atomic<size_t> dequeuePos{0};
+
+    // Producers waiting for a free cell, only written when one parks so consumers' checks stay cache hits
+    alignas(std::hardware_destructive_interference_size) ProducerParking producerParking;
 };
 
-// Constructor
-template<typename T, size_t bufferSize>
-BoundedCircularBufferQueue<T, bufferSize>::BoundedCircularBufferQueue()
-        : bufferMask(bufferSize - 1),
-          buffer(reinterpret_cast<Cell*>(operator new[](sizeof(Cell) * bufferSize))) {
-    for(size_t i = 0; i < bufferSize; i++) {
-        new(&buffer[i]) Cell();
-        buffer[i].sequence.store(i, std::memory_order_relaxed);
+// Constructor, capacity is a power of two
+template<typename T, size_t bufferSize, typename MemoryT, typename LayoutT>
+BoundedCircularBufferQueue<T, bufferSize, MemoryT, LayoutT>::BoundedCircularBufferQueue(size_t capacity, int)
+        : bufferMask(capacity - 1),
+          capacityLog2(log2(capacity)),
+          buffer(reinterpret_cast<Slot*>(MemoryT::Allocate(sizeof(Slot) * capacity))) {
+    for(size_t i = 0; i < capacity; i++) {
+        new(&buffer[i]) Slot();
+    }
+    // the layout may put position i in any slot, so only number the cells once all of them are constructed
+    for(size_t i = 0; i < capacity; i++) {
+        cellAt(i).sequence.store(i, std::memory_order_relaxed);
     }
 }
 
 // Deconstructor
-template<typename T, size_t bufferSize>
-BoundedCircularBufferQueue<T, bufferSize>::~BoundedCircularBufferQueue() {
-    operator delete[](buffer);
+template<typename T, size_t bufferSize, typename MemoryT, typename LayoutT>
+BoundedCircularBufferQueue<T, bufferSize, MemoryT, LayoutT>::~BoundedCircularBufferQueue() {
+    MemoryT::Free(buffer, sizeof(Slot) * GetCapacity());
 }
 
 // Enqueue Implementation
-template<typename T, size_t bufferSize>
-void BoundedCircularBufferQueue<T, bufferSize>::Enqueue(const T &value) {
+template<typename T, size_t bufferSize, typename MemoryT, typename LayoutT>
+void BoundedCircularBufferQueue<T, bufferSize, MemoryT, LayoutT>::Enqueue(const T &value) {
+    producerParking.Wait([&] { return TryEnqueue(value); }, [] { return true; });
+}
+
+template<typename T, size_t bufferSize, typename MemoryT, typename LayoutT>
+bool BoundedCircularBufferQueue<T, bufferSize, MemoryT, LayoutT>::EnqueueWhile(const T &value, const std::atomic<bool>& running) {
+    return producerParking.Wait([&] { return TryEnqueue(value); }, [&] { return running.load(std::memory_order_relaxed); });
+}
+
+template<typename T, size_t bufferSize, typename MemoryT, typename LayoutT>
+bool BoundedCircularBufferQueue<T, bufferSize, MemoryT, LayoutT>::TryEnqueue(const T &value) {
     Cell* cell;
     size_t pos = enqueuePos.load(std::memory_order_relaxed);
 
     while (true) {
-        // since bufferSize is po2, pos & bufferMask == pos % bufferSize
-        cell = &buffer[pos & bufferMask];
+        // the layout maps pos to its cell, since the capacity is po2 pos & bufferMask == pos % capacity
+        cell = &cellAt(pos);
         size_t sequence = cell->sequence.load(std::memory_order_acquire);
         intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
 
@@ -74,7 +152,7 @@ void BoundedCircularBufferQueue<T, bufferSize>::Enqueue(const T &value) {
         }
         else if (diff < 0) {
             // buffer is full
-            return;
+            return false;
         }
         else {
             // different thread won the enqueue, try again
@@ -87,16 +165,17 @@ void BoundedCircularBufferQueue<T, bufferSize>::Enqueue(const T &value) {
 
     // mark cell ready for dequeue
     cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
 }
 
 // Dequeue implementation
-template<typename T, size_t bufferSize>
-bool BoundedCircularBufferQueue<T, bufferSize>::Dequeue(T &out) {
+template<typename T, size_t bufferSize, typename MemoryT, typename LayoutT>
+bool BoundedCircularBufferQueue<T, bufferSize, MemoryT, LayoutT>::Dequeue(T &out) {
     Cell* cell;
     size_t pos = dequeuePos.load(std::memory_order_relaxed);
 
     while (true) {
-        cell = &buffer[pos & bufferMask];
+        cell = &cellAt(pos);
         size_t sequence = cell->sequence.load(std::memory_order_acquire);
         intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
 
@@ -123,5 +202,112 @@ bool BoundedCircularBufferQueue<T, bufferSize>::Dequeue(T &out) {
     // mark cell ready for enqueue
     cell->sequence.store(pos + bufferMask + 1, std::memory_order_release);
 
+    producerParking.Notify();
     return true;
+}
+
+// Bulk Enqueue implementation, claims a run of free cells with a single CAS
+template<typename T, size_t bufferSize, typename MemoryT, typename LayoutT>
+void BoundedCircularBufferQueue<T, bufferSize, MemoryT, LayoutT>::EnqueueBulk(const T* values, size_t count) {
+    size_t enqueued = 0;
+    producerParking.Wait([&] {
+        enqueued += TryEnqueueBulk(values + enqueued, count - enqueued);
+        return enqueued == count;
+    }, [] { return true; });
+}
+
+template<typename T, size_t bufferSize, typename MemoryT, typename LayoutT>
+size_t BoundedCircularBufferQueue<T, bufferSize, MemoryT, LayoutT>::EnqueueBulkWhile(const T* values, size_t count, const std::atomic<bool>& running) {
+    size_t enqueued = 0;
+    producerParking.Wait([&] {
+        enqueued += TryEnqueueBulk(values + enqueued, count - enqueued);
+        return enqueued == count;
+    }, [&] { return running.load(std::memory_order_relaxed); });
+    return enqueued;
+}
+
+template<typename T, size_t bufferSize, typename MemoryT, typename LayoutT>
+size_t BoundedCircularBufferQueue<T, bufferSize, MemoryT, LayoutT>::TryEnqueueBulk(const T* values, size_t count) {
+    size_t enqueued = 0;
+    while (count > 0) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        size_t sequence = cellAt(pos).sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+        if (diff < 0) {
+            // buffer is full
+            return enqueued;
+        }
+        if (diff > 0) {
+            // different thread won the enqueue, try again
+            continue;
+        }
+
+        // count how many cells after pos are also free, a cell is free for position p when its sequence is p
+        size_t claimed = 1;
+        while (claimed < count && claimed <= bufferMask &&
+               cellAt(pos + claimed).sequence.load(std::memory_order_acquire) == pos + claimed) {
+            claimed++;
+        }
+
+        if (!enqueuePos.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed)) {
+            // compare and exchange failed, another thread already swapped it, try again
+            continue;
+        }
+
+        // got claimed cells, fill and mark each ready for dequeue
+        for (size_t i = 0; i < claimed; i++) {
+            Cell* cell = &cellAt(pos + i);
+            cell->data = values[i];
+            cell->sequence.store(pos + i + 1, std::memory_order_release);
+        }
+
+        values += claimed;
+        count -= claimed;
+        enqueued += claimed;
+    }
+    return enqueued;
+}
+
+// Bulk Dequeue implementation, claims a run of ready cells with a single CAS
+template<typename T, size_t bufferSize, typename MemoryT, typename LayoutT>
+size_t BoundedCircularBufferQueue<T, bufferSize, MemoryT, LayoutT>::DequeueBulk(T* out, size_t max) {
+    if (max == 0) return 0;
+
+    while (true) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        size_t sequence = cellAt(pos).sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+
+        if (diff < 0) {
+            // queue is empty
+            return 0;
+        }
+        if (diff > 0) {
+            // another thread beat us, try again
+            continue;
+        }
+
+        // count how many cells after pos are also ready, a cell is ready for position p when its sequence is p + 1
+        size_t claimed = 1;
+        while (claimed < max && claimed <= bufferMask &&
+               cellAt(pos + claimed).sequence.load(std::memory_order_acquire) == pos + claimed + 1) {
+            claimed++;
+        }
+
+        if (!dequeuePos.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed)) {
+            // compare and exchange failed, another thread beat us, try again
+            continue;
+        }
+
+        // got claimed cells, read and mark each ready for enqueue
+        for (size_t i = 0; i < claimed; i++) {
+            Cell* cell = &cellAt(pos + i);
+            out[i] = cell->data;
+            cell->sequence.store(pos + i + bufferMask + 1, std::memory_order_release);
+        }
+
+        producerParking.Notify();
+        return claimed;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Chase-Lev work-stealing deque, using the memory orderings from Lê et al. 2013 (https://fzn.fr/readings/ppopp13.pdf).
+// The owning thread pushes and pops at the bottom without contention, other threads steal from the top with one CAS.
+// The buffer grows when full, old buffers are kept until the deque is destroyed since thieves may still be reading them.
+template<typename T>
+class ChaseLevDeque {
+    static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+public:
+    explicit ChaseLevDeque(size_t initialCapacity = 1024);
+
+    // Owner only
+    void PushBottom(const T& value);
+    bool PopBottom(T& out);
+
+    // Any thread
+    bool Steal(T& out);
+
+private:
+    struct Buffer {
+        explicit Buffer(size_t capacity) : mask(capacity - 1), items(new std::atomic<T>[capacity]) { }
+
+        [[nodiscard]] size_t Capacity() const { return mask + 1; }
+        T Get(int64_t i) const { return items[i & mask].load(std::memory_order_relaxed); }
+        void Put(int64_t i, const T& value) { items[i & mask].store(value, std::memory_order_relaxed); }
+
+        const size_t mask;
+        std::unique_ptr<std::atomic<T>[]> items;
+    };
+
+    Buffer* grow(Buffer* buffer, int64_t t, int64_t b);
+
+    // Padding to avoid false sharing between thieves (top) and the owner (bottom)
+    alignas(std::hardware_destructive_interference_size) std::atomic<int64_t> top{0};
+    alignas(std::hardware_destructive_interference_size) std::atomic<int64_t> bottom{0};
+    std::atomic<Buffer*> buffer;
+
+    // Every buffer this deque has used, owner only
+    std::vector<std::unique_ptr<Buffer>> buffers;
+};
+
+// Constructor, capacity is rounded up to a power of two
+template<typename T>
+ChaseLevDeque<T>::ChaseLevDeque(size_t initialCapacity) {
+    size_t capacity = 1;
+    while (capacity < initialCapacity) capacity <<= 1;
+    buffers.push_back(std::make_unique<Buffer>(capacity));
+    buffer.store(buffers.back().get(), std::memory_order_relaxed);
+}
+
+template<typename T>
+void ChaseLevDeque<T>::PushBottom(const T& value) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    Buffer* a = buffer.load(std::memory_order_relaxed);
+
+    if (b - t > (int64_t)a->Capacity() - 1) {
+        // deque is full
+        a = grow(a, t, b);
+    }
+
+    a->Put(b, value);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+template<typename T>
+bool ChaseLevDeque<T>::PopBottom(T& out) {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    Buffer* a = buffer.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        // deque is empty
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    out = a->Get(b);
+    if (t == b) {
+        // last item, race thieves for it
+        bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+template<typename T>
+bool ChaseLevDeque<T>::Steal(T& out) {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+
+    if (t >= b) {
+        // deque is empty
+        return false;
+    }
+
+    Buffer* a = buffer.load(std::memory_order_acquire);
+    out = a->Get(t);
+    // fails if the owner or another thief took it first
+    return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+// Copies the live range into a buffer twice the size
+template<typename T>
+typename ChaseLevDeque<T>::Buffer* ChaseLevDeque<T>::grow(Buffer* a, int64_t t, int64_t b) {
+    buffers.push_back(std::make_unique<Buffer>(a->Capacity() * 2));
+    Buffer* grown = buffers.back().get();
+    for (int64_t i = t; i < b; i++) {
+        grown->Put(i, a->Get(i));
+    }
+    buffer.store(grown, std::memory_order_release);
+    return grown;
+}
\ No newline at end of file
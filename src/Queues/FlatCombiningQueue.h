@@ -0,0 +1,278 @@
+#pragma once
+
+#include "ProducerParking.h"
+#include "../Evaluation/Wait/CpuRelax.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <queue>
+#include <string>
+#include <thread>
+
+// Flat combining (Hendler, Incze, Shavit & Tzafrir 2010, https://people.csail.mit.edu/shanir/publications/Flat%20Combining%20SPAA%2010.pdf).
+// Instead of every thread taking the lock to push/pop like StdQueueBlocking, each thread publishes its request in its
+// own slot and one thread at a time becomes the combiner: it takes the lock and applies every published request to a
+// plain std::queue. The queue and the lock stay in the combiner's cache, and the other threads only spin on their own
+// slot until the combiner has served them, instead of all bouncing the lock's cache line.
+template<typename T>
+class FlatCombiningQueue {
+    struct Slot;
+public:
+    static std::string GetName() { return "Flat Combining Queue"; }
+
+    FlatCombiningQueue() : id(nextId.fetch_add(1, std::memory_order_relaxed)) { }
+
+    void Enqueue(const T& value) {
+        Slot spare;
+        enqueue(localSlot(spare), value);
+    }
+
+    bool Dequeue(T& out) {
+        Slot spare;
+        return dequeue(localSlot(spare), out);
+    }
+
+    // Bulk requests hand the combiner the caller's array, so a whole batch costs one request
+    void EnqueueBulk(const T* values, size_t count) {
+        Slot spare;
+        enqueueBulk(localSlot(spare), values, count);
+    }
+
+    size_t DequeueBulk(T* out, size_t max) {
+        Slot spare;
+        return dequeueBulk(localSlot(spare), out, max);
+    }
+
+    // Holds the thread's slot, so calls with a token skip the thread_local cache and the lookup by owner. Producer and
+    // consumer tokens of one thread share its slot.
+    class Token {
+    public:
+        explicit Token(FlatCombiningQueue& queue) {
+            std::thread::id self = std::this_thread::get_id();
+            slot = queue.findSlot(self);
+            if (slot == nullptr) slot = queue.claimSlot(self);
+        }
+    private:
+        friend class FlatCombiningQueue;
+        // nullptr if every slot was taken
+        Slot* slot;
+    };
+    using ProducerToken = Token;
+    using ConsumerToken = Token;
+
+    void Enqueue(Token& token, const T& value) {
+        Slot spare;
+        enqueue(token.slot != nullptr ? *token.slot : spare, value);
+    }
+
+    bool Dequeue(Token& token, T& out) {
+        Slot spare;
+        return dequeue(token.slot != nullptr ? *token.slot : spare, out);
+    }
+
+    void EnqueueBulk(Token& token, const T* values, size_t count) {
+        Slot spare;
+        enqueueBulk(token.slot != nullptr ? *token.slot : spare, values, count);
+    }
+
+    size_t DequeueBulk(Token& token, T* out, size_t max) {
+        Slot spare;
+        return dequeueBulk(token.slot != nullptr ? *token.slot : spare, out, max);
+    }
+
+private:
+    // Threads with a slot, more threads than this still work but take the lock for every operation themselves
+    static constexpr size_t maxSlots = 64;
+    // Passes over the slots per combining round, later passes pick up requests published during the first
+    static constexpr int combinePasses = 2;
+    // Rounds of waiting for the lock before a thread without a slot starts yielding
+    static constexpr unsigned spinRounds = 16;
+
+    enum class Operation : uint32_t { None, Enqueue, Dequeue, EnqueueBulk, DequeueBulk };
+
+    // One thread's request. The owner writes the arguments, then publishes operation; the combiner writes the results,
+    // then sets operation back to None.
+    struct alignas(std::hardware_destructive_interference_size) Slot {
+        std::atomic<Operation> operation{Operation::None};
+        T value{};
+        const T* values = nullptr;
+        T* out = nullptr;
+        size_t count = 0;
+        size_t result = 0;
+
+        std::atomic<bool> inUse{false};
+        std::atomic<std::thread::id> owner{};
+    };
+
+    void enqueue(Slot& slot, const T& value) {
+        slot.value = value;
+        perform(slot, Operation::Enqueue);
+    }
+
+    bool dequeue(Slot& slot, T& out) {
+        perform(slot, Operation::Dequeue);
+        if (slot.result == 0) return false;
+        out = slot.value;
+        return true;
+    }
+
+    void enqueueBulk(Slot& slot, const T* values, size_t count) {
+        if (count == 0) return;
+        slot.values = values;
+        slot.count = count;
+        perform(slot, Operation::EnqueueBulk);
+    }
+
+    size_t dequeueBulk(Slot& slot, T* out, size_t max) {
+        if (max == 0) return 0;
+        slot.out = out;
+        slot.count = max;
+        perform(slot, Operation::DequeueBulk);
+        return slot.result;
+    }
+
+    // Publishes the request and waits for a combiner, becoming the combiner whenever the lock is free
+    void perform(Slot& slot, Operation operation) {
+        if (!slot.inUse.load(std::memory_order_relaxed)) {
+            // the caller's spare slot, the combiner doesn't know it so this thread has to apply its own request
+            lock();
+            apply(slot, operation);
+            combine();
+            unlock();
+            return;
+        }
+
+        slot.operation.store(operation, std::memory_order_release);
+        // wait for a combiner to serve the request, becoming the combiner whenever the lock is free. Waiters spin on their
+        // own slot, then park, so a preempted combiner isn't kept off the CPU by threads spinning for it.
+        waiters.Wait([&] {
+            if (slot.operation.load(std::memory_order_acquire) == Operation::None) return true;
+            if (tryLock()) {
+                combine();
+                unlock();
+            }
+            return slot.operation.load(std::memory_order_acquire) == Operation::None;
+        }, [] { return true; });
+    }
+
+    // Applies every published request, called with the lock held
+    void combine() {
+        size_t count = slotCount.load(std::memory_order_acquire);
+        for (int pass = 0; pass < combinePasses; pass++) {
+            bool served = false;
+            for (size_t i = 0; i < count; i++) {
+                Operation operation = slots[i].operation.load(std::memory_order_acquire);
+                if (operation == Operation::None) continue;
+                apply(slots[i], operation);
+                slots[i].operation.store(Operation::None, std::memory_order_release);
+                served = true;
+            }
+            if (!served) break;
+            waiters.Notify();
+        }
+    }
+
+    void apply(Slot& slot, Operation operation) {
+        switch (operation) {
+            case Operation::Enqueue:
+                queue.push(slot.value);
+                break;
+            case Operation::Dequeue:
+                slot.result = queue.empty() ? 0 : 1;
+                if (slot.result != 0) {
+                    slot.value = queue.front();
+                    queue.pop();
+                }
+                break;
+            case Operation::EnqueueBulk:
+                for (size_t i = 0; i < slot.count; i++) {
+                    queue.push(slot.values[i]);
+                }
+                break;
+            case Operation::DequeueBulk:
+                slot.result = 0;
+                while (slot.result < slot.count && !queue.empty()) {
+                    slot.out[slot.result++] = queue.front();
+                    queue.pop();
+                }
+                break;
+            case Operation::None:
+                break;
+        }
+    }
+
+    // Test-and-test-and-set, waiting threads only read the lock word
+    bool tryLock() {
+        return !combinerLocked.load(std::memory_order_relaxed) && !combinerLocked.exchange(true, std::memory_order_acquire);
+    }
+
+    // Yields once the wait has gone on for a while, the combiner may have been preempted while holding the lock
+    void lock() {
+        for (unsigned round = 0; !tryLock(); round++) {
+            if (round < spinRounds) cpuRelax();
+            else std::this_thread::yield();
+        }
+    }
+
+    void unlock() {
+        combinerLocked.store(false, std::memory_order_release);
+    }
+
+    // The calling thread's slot in this queue, or spare if every slot is taken. The last queue a thread used is cached,
+    // other queues are looked up by owner, so a thread that moves between queues (work stealing inboxes) keeps one slot
+    // in each.
+    Slot& localSlot(Slot& spare) {
+        thread_local uint64_t cachedQueue = 0;
+        thread_local Slot* cachedSlot = nullptr;
+        if (cachedQueue == id) return *cachedSlot;
+
+        std::thread::id self = std::this_thread::get_id();
+        Slot* slot = findSlot(self);
+        if (slot == nullptr) slot = claimSlot(self);
+        if (slot == nullptr) return spare;
+
+        cachedQueue = id;
+        cachedSlot = slot;
+        return *slot;
+    }
+
+    Slot* findSlot(std::thread::id self) {
+        size_t count = slotCount.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; i++) {
+            if (slots[i].owner.load(std::memory_order_acquire) == self) return &slots[i];
+        }
+        return nullptr;
+    }
+
+    // Slots are never given back, the job system's threads live as long as its queue
+    Slot* claimSlot(std::thread::id self) {
+        for (size_t i = 0; i < maxSlots; i++) {
+            bool expected = false;
+            if (!slots[i].inUse.load(std::memory_order_relaxed) &&
+                slots[i].inUse.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                slots[i].owner.store(self, std::memory_order_release);
+                // let the combiner scan up to this slot
+                size_t count = slotCount.load(std::memory_order_relaxed);
+                while (count < i + 1 && !slotCount.compare_exchange_weak(count, i + 1, std::memory_order_release)) { }
+                return &slots[i];
+            }
+        }
+        return nullptr;
+    }
+
+    // Tells this queue's slots apart from another queue's in the thread_local cache, even at the same address
+    static inline std::atomic<uint64_t> nextId{1};
+    const uint64_t id;
+
+    alignas(std::hardware_destructive_interference_size) std::atomic<bool> combinerLocked{false};
+    // Only touched by the combiner
+    std::queue<T> queue;
+
+    // Threads waiting for their request to be served, woken after every combining pass
+    alignas(std::hardware_destructive_interference_size) ProducerParking waiters;
+
+    alignas(std::hardware_destructive_interference_size) std::atomic<size_t> slotCount{0};
+    Slot slots[maxSlots];
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <IntrusiveMPSCHook.h>
+
+#include <atomic>
+#include <new>
+#include <string>
+#include <type_traits>
+
+// Intrusive multi-producer single-consumer queue (https://www.1024cores.net/home/lock-free-algorithms/queues/intrusive-mpsc-node-based-queue).
+// Items are linked through their own IntrusiveMPSCHook, so Enqueue is a single atomic exchange and never allocates.
+// T must be a pointer to a type deriving from IntrusiveMPSCHook, and an item must be claimed with TryLink before it is
+// enqueued (it is released again when dequeued).
+template<typename T>
+class IntrusiveMPSCQueue {
+    static_assert(std::is_pointer_v<T> && std::is_base_of_v<IntrusiveMPSCHook, std::remove_pointer_t<T>>,
+                  "T must be a pointer to a type deriving from IntrusiveMPSCHook");
+public:
+    static std::string GetName() { return "Intrusive MPSC Queue"; }
+
+    // Any number of threads may enqueue but only one thread may dequeue
+    static constexpr int maxConsumers = 1;
+    static constexpr bool isIntrusive = true;
+
+    // Constructor and Deconstructor
+    IntrusiveMPSCQueue();
+    ~IntrusiveMPSCQueue();
+
+    // Enqueue and Dequeue declaration
+    void Enqueue(const T& value);
+    bool Dequeue(T& out);
+
+    // Bulk Enqueue and Dequeue declaration
+    void EnqueueBulk(const T* values, size_t count);
+    size_t DequeueBulk(T* out, size_t max);
+
+private:
+    // Links first..last (already linked to each other) after the most recently enqueued item
+    void push(IntrusiveMPSCHook* first, IntrusiveMPSCHook* last);
+
+    // Hands a dequeued item out and lets it be enqueued again
+    bool release(IntrusiveMPSCHook* node, T& out);
+
+    // Producers exchange head, the consumer owns tail. The stub keeps the list non-empty.
+    alignas(std::hardware_destructive_interference_size) std::atomic<IntrusiveMPSCHook*> head;
+    alignas(std::hardware_destructive_interference_size) IntrusiveMPSCHook* tail;
+    IntrusiveMPSCHook stub;
+};
+
+// Constructor
+template<typename T>
+IntrusiveMPSCQueue<T>::IntrusiveMPSCQueue() : head(&stub), tail(&stub) { }
+
+// Deconstructor, releases anything left so the items can be enqueued into another queue
+template<typename T>
+IntrusiveMPSCQueue<T>::~IntrusiveMPSCQueue() {
+    T item;
+    while (Dequeue(item)) { }
+}
+
+// Enqueue implementation
+template<typename T>
+void IntrusiveMPSCQueue<T>::Enqueue(const T& value) {
+    push(value, value);
+}
+
+// Dequeue implementation
+template<typename T>
+bool IntrusiveMPSCQueue<T>::Dequeue(T& out) {
+    IntrusiveMPSCHook* node = tail;
+    IntrusiveMPSCHook* next = node->mpscNext.load(std::memory_order_acquire);
+
+    if (node == &stub) {
+        if (next == nullptr) {
+            // queue is empty
+            return false;
+        }
+        // skip over the stub
+        tail = next;
+        node = next;
+        next = next->mpscNext.load(std::memory_order_acquire);
+    }
+
+    if (next != nullptr) {
+        tail = next;
+        return release(node, out);
+    }
+
+    if (node != head.load(std::memory_order_acquire)) {
+        // a producer has exchanged head but not linked its item yet, it will be visible shortly
+        return false;
+    }
+
+    // node is the last item, put the stub back behind it so it can be unlinked
+    push(&stub, &stub);
+
+    next = node->mpscNext.load(std::memory_order_acquire);
+    if (next != nullptr) {
+        tail = next;
+        return release(node, out);
+    }
+    return false;
+}
+
+// Bulk Enqueue implementation, links the items to each other privately and publishes them with one exchange
+template<typename T>
+void IntrusiveMPSCQueue<T>::EnqueueBulk(const T* values, size_t count) {
+    if (count == 0) return;
+
+    for (size_t i = 0; i + 1 < count; i++) {
+        values[i]->mpscNext.store(values[i + 1], std::memory_order_relaxed);
+    }
+    push(values[0], values[count - 1]);
+}
+
+// Bulk Dequeue implementation
+template<typename T>
+size_t IntrusiveMPSCQueue<T>::DequeueBulk(T* out, size_t max) {
+    size_t count = 0;
+    while (count < max && Dequeue(out[count])) {
+        count++;
+    }
+    return count;
+}
+
+template<typename T>
+void IntrusiveMPSCQueue<T>::push(IntrusiveMPSCHook* first, IntrusiveMPSCHook* last) {
+    last->mpscNext.store(nullptr, std::memory_order_relaxed);
+    IntrusiveMPSCHook* prev = head.exchange(last, std::memory_order_acq_rel);
+    prev->mpscNext.store(first, std::memory_order_release);
+}
+
+template<typename T>
+bool IntrusiveMPSCQueue<T>::release(IntrusiveMPSCHook* node, T& out) {
+    out = static_cast<T>(node);
+    node->linked.store(false, std::memory_order_release);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <string>
+
+// Cell layouts of a ring buffer. Each wraps a cell in a Slot and maps a position to the index of the slot that holds it,
+// given the capacity (a power of two) as mask and log2.
+
+/// Cells side by side, so small cells share cache lines with their neighbours
+struct PackedCellLayout {
+    static std::string GetName() { return "Packed"; }
+
+    template<typename CellT>
+    struct Slot {
+        CellT cell;
+    };
+
+    template<typename CellT>
+    static size_t Index(size_t pos, size_t mask, unsigned) {
+        return pos & mask;
+    }
+};
+
+/// Every cell gets its own cache line, so threads working on neighbouring positions never false share, at the cost of
+/// several times the memory
+struct PaddedCellLayout {
+    static std::string GetName() { return "Padded"; }
+
+    template<typename CellT>
+    struct alignas(std::hardware_destructive_interference_size) Slot {
+        CellT cell;
+    };
+
+    template<typename CellT>
+    static size_t Index(size_t pos, size_t mask, unsigned) {
+        return pos & mask;
+    }
+};
+
+/// Cells stay packed, but consecutive positions are spread over different cache lines: the index's bits are rotated
+/// left by log2(cells per line), so position i + 1 lands one line after i and a line is only revisited after
+/// capacity / cellsPerLine positions. Keeps the packed memory use while avoiding most of the false sharing.
+struct SwizzledCellLayout {
+    static std::string GetName() { return "Swizzled"; }
+
+    template<typename CellT>
+    struct Slot {
+        CellT cell;
+    };
+
+    template<typename CellT>
+    static size_t Index(size_t pos, size_t mask, unsigned capacityLog2) {
+        constexpr unsigned shift = lineShift(std::hardware_destructive_interference_size / sizeof(Slot<CellT>));
+        size_t index = pos & mask;
+        // a buffer that fits in one line has nothing to spread
+        if (capacityLog2 <= shift) return index;
+        return ((index << shift) | (index >> (capacityLog2 - shift))) & mask;
+    }
+
+private:
+    // log2 of the largest power of two <= cellsPerLine
+    static constexpr unsigned lineShift(size_t cellsPerLine) {
+        unsigned shift = 0;
+        while (cellsPerLine >= 2) {
+            cellsPerLine >>= 1;
+            shift++;
+        }
+        return shift;
+    }
+};
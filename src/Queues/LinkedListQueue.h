@@ -1,9 +1,12 @@
 #pragma once
-#include <IQueue.h>
+#include "Reclamation/HazardPointerReclaimer.h"
+#include "Allocation/HeapNodeAllocator.h"
 #include <atomic>
 
-template<typename T>
-class LinkedListQueue : public IQueue<T>{
+// ReclaimerT decides when dequeued nodes are freed (see Reclamation/), since other consumers may still be reading them
+// AllocatorT decides where nodes come from and go back to (see Allocation/)
+template<typename T, typename ReclaimerT = HazardPointerReclaimer, typename AllocatorT = HeapNodeAllocator>
+class LinkedListQueue {
 private:
     struct Node {
         T data;
@@ -13,12 +16,23 @@ private:
     std::atomic<Node*> head;
     std::atomic<Node*> tail;
 
+    static Node* newNode(const T& data) {
+        return AllocatorT::template New<Node>(data);
+    }
+
+    static void deleteNode(void* node) {
+        AllocatorT::Delete(static_cast<Node*>(node));
+    }
+
 public:
-    static std::string GetName() { return "Linked List Queue"; }
+    using Reclaimer = ReclaimerT;
+    static constexpr size_t nodeSize = sizeof(Node);
+
+    static std::string GetName() { return "Linked List Queue (" + ReclaimerT::GetName() + ", " + AllocatorT::GetName() + ")"; }
 
     // Constructor and Deconstructor
     LinkedListQueue() {
-        Node* dummy = new Node(nullptr);
+        Node* dummy = newNode(nullptr);
         head.store(dummy);
         tail.store(dummy);
     }
@@ -26,22 +40,97 @@ public:
         Node* node = head.load();
         while (node != nullptr) {
             Node* next = node->next.load();
-            delete node;
+            deleteNode(node);
             node = next;
         }
     }
 
     // Enqueue function
-    void Enqueue(const T& value) override {
-        Node* new_node = new Node(value);
+    void Enqueue(const T& value) {
+        Node* new_node = newNode(value);
+        typename ReclaimerT::Guard guard;
+        link(guard, new_node, new_node);
+    }
+
+    // Dequeue function
+    bool Dequeue(T& out) {
+        typename ReclaimerT::Guard guard;
+        return dequeue(guard, out);
+    }
+
+    // Bulk Enqueue function, links the values into a private chain and splices it on with a single CAS
+    void EnqueueBulk(const T* values, size_t count) {
+        if (count == 0) return;
+        Node* chain_tail;
+        Node* chain_head = newChain(values, count, chain_tail);
+        typename ReclaimerT::Guard guard;
+        link(guard, chain_head, chain_tail);
+    }
+
+    // Bulk Dequeue function, advances head past up to max nodes with a single CAS
+    size_t DequeueBulk(T* out, size_t max) {
+        if (max == 0) return 0;
+        typename ReclaimerT::Guard guard;
+        return dequeueBulk(guard, out, max);
+    }
+
+    // Holds the thread's reclamation record, so guards made with a token skip looking it up
+    class Token {
+    public:
+        explicit Token(LinkedListQueue&) { }
+    private:
+        friend class LinkedListQueue;
+        typename ReclaimerT::Local local;
+    };
+    using ProducerToken = Token;
+    using ConsumerToken = Token;
+
+    void Enqueue(Token& token, const T& value) {
+        Node* new_node = newNode(value);
+        typename ReclaimerT::Guard guard(token.local);
+        link(guard, new_node, new_node);
+    }
+    bool Dequeue(Token& token, T& out) {
+        typename ReclaimerT::Guard guard(token.local);
+        return dequeue(guard, out);
+    }
+    void EnqueueBulk(Token& token, const T* values, size_t count) {
+        if (count == 0) return;
+        Node* chain_tail;
+        Node* chain_head = newChain(values, count, chain_tail);
+        typename ReclaimerT::Guard guard(token.local);
+        link(guard, chain_head, chain_tail);
+    }
+    size_t DequeueBulk(Token& token, T* out, size_t max) {
+        if (max == 0) return 0;
+        typename ReclaimerT::Guard guard(token.local);
+        return dequeueBulk(guard, out, max);
+    }
+
+private:
+    // Links count new nodes holding values into a chain nothing else can see yet, returns its first node
+    static Node* newChain(const T* values, size_t count, Node*& chain_tail) {
+        Node* chain_head = newNode(values[0]);
+        chain_tail = chain_head;
+        for (size_t i = 1; i < count; i++) {
+            Node* node = newNode(values[i]);
+            chain_tail->next.store(node, std::memory_order_relaxed);
+            chain_tail = node;
+        }
+        return chain_head;
+    }
+
+    // Splices the chain chain_head .. chain_tail on after the last node. The caller's guard protects slot 0.
+    void link(typename ReclaimerT::Guard& guard, Node* chain_head, Node* chain_tail) {
         while (true) {
-            Node* last = tail.load();
+            Node* last = guard.Protect(0, tail);
             Node* next = last->next.load();
             if (last == tail.load()) {
                 if (next == nullptr) {
                     //CAS: compare and swap = compare exchange weak
-                    if (last->next.compare_exchange_weak(next, new_node)) {
-                        tail.compare_exchange_weak(last, new_node);
+                    if (last->next.compare_exchange_weak(next, chain_head)) {
+                        // other threads help tail along the chain if this fails
+                        tail.compare_exchange_weak(last, chain_tail);
                         return;
                     }
                 } else {
@@ -49,15 +138,14 @@ public:
                 }
             }
         }
-        //CAS here?
     }
 
-    // Dequeue function
-    bool Dequeue(T& out) override {
+    // The caller's guard protects slots 0 and 1
+    bool dequeue(typename ReclaimerT::Guard& guard, T& out) {
         while (true) {
-            Node* first = head.load();
+            Node* first = guard.Protect(0, head);
             Node* last = tail.load();
-            Node* next = first->next.load();
+            Node* next = guard.Protect(1, first->next);
             if (first == head.load()) {
                 if (first == last) {
                     if (next == nullptr) {
@@ -67,7 +155,7 @@ public:
                 } else {
                     out = next-> data;
                     if (head.compare_exchange_weak(first, next)) {
-                        delete first; //free old dummy node
+                        ReclaimerT::Retire(first, &deleteNode); //free old dummy node
                         return true;
                     }
                 }
@@ -75,6 +163,51 @@ public:
         }
     }
 
+    // The caller's guard protects slots 0 to 2
+    size_t dequeueBulk(typename ReclaimerT::Guard& guard, T* out, size_t max) {
+        while (true) {
+            Node* first = guard.Protect(0, head);
+            Node* last = tail.load();
+            Node* next = guard.Protect(1, first->next);
+            if (first == head.load()) {
+                if (first == last) {
+                    if (next == nullptr) {
+                        return 0;
+                    }
+                    tail.compare_exchange_weak(last, next);
+                } else {
+                    // walk forward, never past the tail that was observed so head can't overtake it
+                    Node* new_head = first;
+                    size_t count = 0;
+                    bool stale = false;
+                    while (count < max && new_head != last) {
+                        // alternate slots 1 and 2 so new_head stays protected while its successor is published
+                        Node* node = guard.Protect(1 + (count & 1), new_head->next);
+                        if (node == nullptr) break;
+                        // nothing past head has been retired while head is unchanged
+                        if (head.load() != first) {
+                            stale = true;
+                            break;
+                        }
+                        out[count++] = node->data;
+                        new_head = node;
+                    }
+                    if (stale) continue;
+
+                    if (head.compare_exchange_weak(first, new_head)) {
+                        // free the old dummy node and every node that was passed over
+                        while (first != new_head) {
+                            Node* node = first->next.load();
+                            ReclaimerT::Retire(first, &deleteNode);
+                            first = node;
+                        }
+                        return count;
+                    }
+                }
+            }
+        }
+    }
+
 };
 #ifndef CLIONPROJECTS_LINKEDLISTQUEUE_H
 #define CLIONPROJECTS_LINKEDLISTQUEUE_H
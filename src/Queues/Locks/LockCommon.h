@@ -0,0 +1,23 @@
+#pragma once
+
+#include "../../Evaluation/Wait/CpuRelax.h"
+
+#include <thread>
+
+// Spins with pause instructions while a lock is held, then yields. With more threads than cores the holder (or, for
+// the fair locks, the next thread in line) may be preempted, and a waiter spinning on its core keeps it from running.
+class LockSpinner {
+public:
+    void Spin() {
+        if (rounds < spinRounds) {
+            rounds++;
+            cpuRelax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    static constexpr unsigned spinRounds = 1024;
+    unsigned rounds = 0;
+};
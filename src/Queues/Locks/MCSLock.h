@@ -0,0 +1,77 @@
+#pragma once
+
+#include "LockCommon.h"
+
+#include <atomic>
+#include <cassert>
+#include <new>
+#include <string>
+
+/// MCS queue lock (Mellor-Crummey & Scott 1991, https://www.cs.rochester.edu/u/scott/papers/1991_TOCS_synch.pdf).
+/// Waiters link themselves into a queue and each spins on a flag in its own node, so a release only touches the cache
+/// line of the next thread in line. FIFO like the ticket lock, without every waiter bouncing one shared line.
+/// Nodes come from a small per-thread stack, so a thread can hold a few MCS locks at once as long as it releases them
+/// in reverse order (as std::lock_guard does).
+class MCSLock {
+public:
+    static std::string GetName() { return "MCS Lock"; }
+
+    void lock() {
+        Node* node = localNodes().Push();
+        node->next.store(nullptr, std::memory_order_relaxed);
+        node->locked.store(true, std::memory_order_relaxed);
+
+        Node* predecessor = tail.exchange(node, std::memory_order_acq_rel);
+        if (predecessor != nullptr) {
+            predecessor->next.store(node, std::memory_order_release);
+            LockSpinner spinner;
+            while (node->locked.load(std::memory_order_acquire)) spinner.Spin();
+        }
+        holder = node;
+    }
+
+    void unlock() {
+        Node* node = holder;
+        Node* successor = node->next.load(std::memory_order_acquire);
+        if (successor == nullptr) {
+            Node* expected = node;
+            if (tail.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel)) {
+                localNodes().Pop();
+                return;
+            }
+            // a thread is linking itself in behind this one, wait until it has
+            LockSpinner spinner;
+            while ((successor = node->next.load(std::memory_order_acquire)) == nullptr) spinner.Spin();
+        }
+        successor->locked.store(false, std::memory_order_release);
+        localNodes().Pop();
+    }
+
+private:
+    struct alignas(std::hardware_destructive_interference_size) Node {
+        std::atomic<Node*> next{nullptr};
+        std::atomic<bool> locked{false};
+    };
+
+    // A thread's nodes, one per MCS lock it currently holds or waits for
+    struct NodeStack {
+        static constexpr size_t maxDepth = 4;
+        Node nodes[maxDepth];
+        size_t depth = 0;
+
+        Node* Push() {
+            assert(depth < maxDepth && "too many MCS locks held at once");
+            return &nodes[depth++];
+        }
+        void Pop() { depth--; }
+    };
+
+    static NodeStack& localNodes() {
+        thread_local NodeStack stack;
+        return stack;
+    }
+
+    alignas(std::hardware_destructive_interference_size) std::atomic<Node*> tail{nullptr};
+    // Node of the thread holding the lock, only read by that thread when it unlocks
+    Node* holder = nullptr;
+};
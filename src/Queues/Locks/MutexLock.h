@@ -0,0 +1,16 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+
+/// std::mutex, which spins briefly and then sleeps in the kernel (a futex on Linux) until the holder wakes it
+class MutexLock {
+public:
+    static std::string GetName() { return "std::mutex"; }
+
+    void lock() { mutex.lock(); }
+    void unlock() { mutex.unlock(); }
+
+private:
+    std::mutex mutex;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "LockCommon.h"
+
+#include <atomic>
+#include <string>
+
+/// Test-and-test-and-set spin lock. Waiters spin reading the flag, which stays in their cache until the holder
+/// releases it, and only then try the exchange. Unfair, and every release makes all waiters race for the line.
+class TTASSpinLock {
+public:
+    static std::string GetName() { return "TTAS Spin Lock"; }
+
+    void lock() {
+        LockSpinner spinner;
+        while (locked.exchange(true, std::memory_order_acquire)) {
+            while (locked.load(std::memory_order_relaxed)) spinner.Spin();
+        }
+    }
+
+    void unlock() {
+        locked.store(false, std::memory_order_release);
+    }
+
+private:
+    std::atomic<bool> locked{false};
+};
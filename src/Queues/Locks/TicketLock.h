@@ -0,0 +1,30 @@
+#pragma once
+
+#include "LockCommon.h"
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <string>
+
+/// Ticket lock. Each thread takes a ticket with fetch_add and waits until it is served, so the lock is handed out in
+/// FIFO order. Waiters all spin on nowServing, so every release still invalidates it in every waiter's cache.
+class TicketLock {
+public:
+    static std::string GetName() { return "Ticket Lock"; }
+
+    void lock() {
+        uint32_t ticket = nextTicket.fetch_add(1, std::memory_order_relaxed);
+        LockSpinner spinner;
+        while (nowServing.load(std::memory_order_acquire) != ticket) spinner.Spin();
+    }
+
+    void unlock() {
+        // only the holder writes nowServing
+        nowServing.store(nowServing.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    alignas(std::hardware_destructive_interference_size) std::atomic<uint32_t> nextTicket{0};
+    alignas(std::hardware_destructive_interference_size) std::atomic<uint32_t> nowServing{0};
+};
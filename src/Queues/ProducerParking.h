@@ -0,0 +1,92 @@
+#pragma once
+
+#include "../Evaluation/Wait/CpuRelax.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+/// Lets producers of a bounded queue wait for room instead of dropping values: a producer that finds the queue full
+/// spins for a while, then parks until a consumer frees a cell.
+/// Consumers call Notify after every successful dequeue. While no producer is parked that is a single relaxed load, so
+/// unlike ParkingWaitStrategy the dequeue fast path has no fence. The price is that a producer parking at the same
+/// moment a consumer frees the last cell can miss that wake-up, so every park is bounded by maxPark, after which the
+/// producer looks at the queue again.
+class ProducerParking {
+public:
+    // Calls tryEnqueue until it returns true. Gives up and returns false once keepWaiting() returns false.
+    template<typename TryEnqueue, typename KeepWaiting>
+    bool Wait(TryEnqueue&& tryEnqueue, KeepWaiting&& keepWaiting) {
+        for (unsigned round = 0; ; round++) {
+            if (tryEnqueue()) return true;
+            if (!keepWaiting()) return false;
+            if (round < spinRounds) {
+                cpuRelax();
+                continue;
+            }
+
+            parked.fetch_add(1, std::memory_order_seq_cst);
+            uint32_t key = epoch.load(std::memory_order_seq_cst);
+            // look again now that consumers can see this producer, a cell freed before that wouldn't wake it
+            if (tryEnqueue()) {
+                parked.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+            sleep(key);
+            parked.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Called by consumers after dequeueing, wakes every parked producer
+    void Notify() {
+        if (parked.load(std::memory_order_relaxed) == 0) return;
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        wake();
+    }
+
+private:
+    // Full-queue rounds spent spinning before a producer parks
+    static constexpr unsigned spinRounds = 256;
+    static constexpr std::chrono::microseconds maxPark{100};
+
+#if defined(__linux__)
+    // Sleeps unless the epoch has already moved on from key, for at most maxPark
+    void sleep(uint32_t key) {
+        timespec timeout{0, (long)std::chrono::nanoseconds(maxPark).count()};
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch), FUTEX_WAIT_PRIVATE, key, &timeout, nullptr, 0);
+    }
+
+    void wake() {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+    }
+#else
+    void sleep(uint32_t key) {
+        std::unique_lock lock(mutex);
+        cv.wait_for(lock, maxPark, [&] { return epoch.load() != key; });
+    }
+
+    void wake() {
+        // taking the lock orders the epoch bump before a sleeper's check
+        { std::lock_guard lock(mutex); }
+        cv.notify_all();
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+#endif
+
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex needs a plain 32-bit word");
+
+    std::atomic<uint32_t> epoch{0};
+    std::atomic<uint32_t> parked{0};
+};
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "ReclamationCommon.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+/// Epoch-based reclamation (Fraser 2004, https://www.cl.cam.ac.uk/techreports/UCAM-CL-TR-579.pdf).
+/// Threads pin the global epoch for the duration of an operation. A retired node is tagged with the global epoch at
+/// retirement and freed once the epoch has advanced twice, which can only happen after every thread that could have
+/// seen the node has unpinned. Cheaper per operation than hazard pointers, but one stalled thread stops all freeing.
+class EpochReclaimer {
+    struct Record;
+public:
+    static std::string GetName() { return "Epoch Based"; }
+
+    class Local;
+
+    // Pins the calling thread to the current global epoch for the duration of one queue operation. Guards do not nest.
+    class Guard {
+    public:
+        Guard() : record(localRecord()) { pin(); }
+        explicit Guard(Local& local) : record(local.record) { pin(); }
+        ~Guard() {
+            record.state.store(epoch << 1, std::memory_order_release);
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        // Nodes loaded while pinned stay valid until the guard is destroyed
+        template<typename P>
+        P* Protect(size_t /*slot*/, const std::atomic<P*>& src) {
+            return src.load();
+        }
+
+    private:
+        void pin() {
+            auto& globalEpoch = domain().globalEpoch;
+            do {
+                epoch = globalEpoch.load();
+                record.state.store((epoch << 1) | 1);
+            } while (globalEpoch.load() != epoch);
+        }
+
+        Record& record;
+        size_t epoch;
+    };
+
+    // The calling thread's record looked up once, guards made from it skip the thread_local lookup. Only valid on the
+    // thread that made it.
+    class Local {
+    public:
+        Local() : record(localRecord()) { }
+    private:
+        friend class Guard;
+        Record& record;
+    };
+
+    static void Retire(void* ptr, void (*deleter)(void*)) {
+        Record& record = localRecord();
+        size_t epoch = domain().globalEpoch.load();
+
+        Bucket& bucket = record.buckets[epoch % bucketCount];
+        if (bucket.epoch != epoch) {
+            // the bucket holds nodes from at least three epochs ago
+            freeBucket(record, bucket);
+            bucket.epoch = epoch;
+        }
+        bucket.nodes.push_back({ ptr, deleter });
+        record.size++;
+
+        if (++record.retiresSinceAdvance >= advanceInterval) {
+            record.retiresSinceAdvance = 0;
+            report(record);
+            tryAdvance();
+            collect(record);
+            report(record);
+        }
+    }
+
+    // Frees every thread's retired nodes regardless of their epoch. Only safe while no thread is pinned or retires,
+    // e.g. between runs once the workers have been joined.
+    static void Drain() {
+        for (Record* record = domain().registry.Head(); record != nullptr; record = record->next) {
+            for (auto& bucket : record->buckets) {
+                freeBucket(*record, bucket);
+            }
+            report(*record);
+        }
+    }
+
+    static void ResetStats() { domain().counter.ResetHighWater(); }
+    static size_t GetRetiredHighWater() { return domain().counter.GetHighWater(); }
+
+private:
+    static constexpr size_t bucketCount = 3;
+    static constexpr size_t advanceInterval = 64;
+
+    struct Bucket {
+        size_t epoch = 0;
+        std::vector<RetiredNode> nodes;
+    };
+
+    struct Record {
+        std::atomic<size_t> state{0}; // (epoch << 1) | pinned
+        Bucket buckets[bucketCount];
+        size_t size = 0;
+        size_t reported = 0;
+        size_t retiresSinceAdvance = 0;
+
+        std::atomic<bool> inUse{false};
+        Record* next = nullptr;
+
+        ~Record() {
+            for (auto& bucket : buckets) {
+                for (const auto& node : bucket.nodes) {
+                    node.deleter(node.ptr);
+                }
+            }
+        }
+    };
+
+    struct Domain {
+        std::atomic<size_t> globalEpoch{0};
+        ThreadRecordRegistry<Record> registry;
+        RetiredCounter counter;
+    };
+
+    // Gives the record back when the owning thread exits
+    struct LocalHandle {
+        Record* record = nullptr;
+        ~LocalHandle() {
+            if (record != nullptr) {
+                collect(*record);
+                report(*record);
+                domain().registry.Release(record);
+            }
+        }
+    };
+
+    static Domain& domain() {
+        static Domain instance;
+        return instance;
+    }
+
+    static Record& localRecord() {
+        thread_local LocalHandle handle;
+        if (handle.record == nullptr) {
+            handle.record = domain().registry.Acquire();
+        }
+        return *handle.record;
+    }
+
+    // Advances the global epoch if every pinned thread has observed the current one
+    static void tryAdvance() {
+        size_t epoch = domain().globalEpoch.load();
+        for (Record* record = domain().registry.Head(); record != nullptr; record = record->next) {
+            size_t state = record->state.load();
+            if ((state & 1) && (state >> 1) != epoch) return;
+        }
+        domain().globalEpoch.compare_exchange_strong(epoch, epoch + 1);
+    }
+
+    // Frees the buckets that are at least two epochs old
+    static void collect(Record& record) {
+        size_t epoch = domain().globalEpoch.load();
+        for (auto& bucket : record.buckets) {
+            if (bucket.epoch + 2 <= epoch) {
+                freeBucket(record, bucket);
+            }
+        }
+    }
+
+    static void freeBucket(Record& record, Bucket& bucket) {
+        for (const auto& node : bucket.nodes) {
+            node.deleter(node.ptr);
+        }
+        record.size -= bucket.nodes.size();
+        bucket.nodes.clear();
+    }
+
+    // Reports the change in this record's retired node count to the domain's counter
+    static void report(Record& record) {
+        if (record.size > record.reported) domain().counter.Add(record.size - record.reported);
+        else domain().counter.Remove(record.reported - record.size);
+        record.reported = record.size;
+    }
+};
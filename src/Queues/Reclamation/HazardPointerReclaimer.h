@@ -0,0 +1,164 @@
+#pragma once
+
+#include "ReclamationCommon.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+/// Hazard pointers (Michael 2004, https://www.cs.otago.ac.nz/cosc440/readings/hazard-pointers.pdf).
+/// Each thread publishes the nodes it is about to dereference in a few hazard slots. Retired nodes are kept in a
+/// per-thread list and only freed by a scan once no thread has them in a hazard slot.
+class HazardPointerReclaimer {
+    struct Record;
+public:
+    // Slots per thread. The linked list queue needs two for single dequeues and three to walk nodes in bulk dequeues.
+    static constexpr size_t slotsPerThread = 3;
+
+    static std::string GetName() { return "Hazard Pointers"; }
+
+    class Local;
+
+    // Holds the calling thread's hazard slots for the duration of one queue operation
+    class Guard {
+    public:
+        Guard() : record(localRecord()) { }
+        explicit Guard(Local& local) : record(local.record) { }
+        ~Guard() {
+            for (auto& hazard : record.hazards) {
+                hazard.store(nullptr, std::memory_order_release);
+            }
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        // Loads src and publishes it in slot, retrying until the published value is still current. The caller must
+        // still validate that the node is reachable before dereferencing it.
+        template<typename P>
+        P* Protect(size_t slot, const std::atomic<P*>& src) {
+            P* ptr = src.load();
+            while (true) {
+                record.hazards[slot].store(ptr);
+                P* current = src.load();
+                if (current == ptr) return ptr;
+                ptr = current;
+            }
+        }
+
+    private:
+        Record& record;
+    };
+
+    // The calling thread's record looked up once, guards made from it skip the thread_local lookup. Only valid on the
+    // thread that made it.
+    class Local {
+    public:
+        Local() : record(localRecord()) { }
+    private:
+        friend class Guard;
+        Record& record;
+    };
+
+    static void Retire(void* ptr, void (*deleter)(void*)) {
+        Record& record = localRecord();
+        record.retired.push_back({ ptr, deleter });
+
+        size_t threshold = std::max<size_t>(minScanThreshold, 2 * slotsPerThread * domain().registry.Size());
+        if (record.retired.size() >= threshold) {
+            scan(record);
+        }
+    }
+
+    // Frees every thread's retired nodes. Only safe while no thread holds a guard or retires, e.g. between runs once
+    // the workers have been joined, when nothing is published in any hazard slot.
+    static void Drain() {
+        for (Record* record = domain().registry.Head(); record != nullptr; record = record->next) {
+            scan(*record);
+        }
+    }
+
+    static void ResetStats() { domain().counter.ResetHighWater(); }
+    static size_t GetRetiredHighWater() { return domain().counter.GetHighWater(); }
+
+private:
+    static constexpr size_t minScanThreshold = 64;
+
+    struct Record {
+        std::atomic<void*> hazards[slotsPerThread]{};
+        std::vector<RetiredNode> retired;
+        std::vector<void*> scratch;
+        size_t reported = 0;
+
+        std::atomic<bool> inUse{false};
+        Record* next = nullptr;
+
+        ~Record() {
+            for (const auto& node : retired) {
+                node.deleter(node.ptr);
+            }
+        }
+    };
+
+    struct Domain {
+        ThreadRecordRegistry<Record> registry;
+        RetiredCounter counter;
+    };
+
+    // Gives the record back when the owning thread exits
+    struct LocalHandle {
+        Record* record = nullptr;
+        ~LocalHandle() {
+            if (record != nullptr) {
+                scan(*record);
+                domain().registry.Release(record);
+            }
+        }
+    };
+
+    static Domain& domain() {
+        static Domain instance;
+        return instance;
+    }
+
+    static Record& localRecord() {
+        thread_local LocalHandle handle;
+        if (handle.record == nullptr) {
+            handle.record = domain().registry.Acquire();
+        }
+        return *handle.record;
+    }
+
+    // Reports the change in this record's retired list size to the domain's counter
+    static void report(Record& record) {
+        size_t size = record.retired.size();
+        if (size > record.reported) domain().counter.Add(size - record.reported);
+        else domain().counter.Remove(record.reported - size);
+        record.reported = size;
+    }
+
+    // Frees every retired node that is not currently published in any thread's hazard slots
+    static void scan(Record& record) {
+        report(record);
+
+        record.scratch.clear();
+        for (Record* other = domain().registry.Head(); other != nullptr; other = other->next) {
+            for (const auto& hazard : other->hazards) {
+                void* ptr = hazard.load();
+                if (ptr != nullptr) record.scratch.push_back(ptr);
+            }
+        }
+        std::sort(record.scratch.begin(), record.scratch.end());
+
+        auto stillHazardous = std::partition(record.retired.begin(), record.retired.end(), [&](const RetiredNode& node) {
+            return std::binary_search(record.scratch.begin(), record.scratch.end(), node.ptr);
+        });
+        for (auto it = stillHazardous; it != record.retired.end(); ++it) {
+            it->deleter(it->ptr);
+        }
+        record.retired.erase(stillHazardous, record.retired.end());
+
+        report(record);
+    }
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "ReclamationCommon.h"
+
+#include <atomic>
+#include <string>
+
+/// Frees nodes as soon as they are retired. This is what the queues did before reclamation was added: it has no
+/// overhead, but another thread may still be reading a node when it is deleted, so it is only safe with one consumer.
+class ImmediateReclaimer {
+public:
+    static std::string GetName() { return "Immediate (unsafe)"; }
+
+    // No per-thread state
+    class Local { };
+
+    class Guard {
+    public:
+        Guard() = default;
+        explicit Guard(Local&) { }
+
+        template<typename P>
+        P* Protect(size_t /*slot*/, const std::atomic<P*>& src) {
+            return src.load();
+        }
+    };
+
+    static void Retire(void* ptr, void (*deleter)(void*)) {
+        deleter(ptr);
+    }
+
+    static void Drain() { }
+    static void ResetStats() { }
+    static size_t GetRetiredHighWater() { return 0; }
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
+// A node that has been unlinked from a data structure but may still be referenced by other threads
+struct RetiredNode {
+    void* ptr;
+    void (*deleter)(void*);
+};
+
+// Tracks how many retired nodes are waiting to be freed, and the highest that number has reached
+class RetiredCounter {
+public:
+    void Add(size_t count) {
+        size_t now = pending.fetch_add(count, std::memory_order_relaxed) + count;
+        size_t highWater = retiredHighWater.load(std::memory_order_relaxed);
+        while (now > highWater && !retiredHighWater.compare_exchange_weak(highWater, now, std::memory_order_relaxed)) { }
+    }
+
+    void Remove(size_t count) {
+        pending.fetch_sub(count, std::memory_order_relaxed);
+    }
+
+    // Makes the high-water mark start again from the current number of pending nodes
+    void ResetHighWater() {
+        retiredHighWater.store(pending.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] size_t GetPending() const { return pending.load(std::memory_order_relaxed); }
+    [[nodiscard]] size_t GetHighWater() const { return retiredHighWater.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<size_t> pending{0};
+    std::atomic<size_t> retiredHighWater{0};
+};
+
+// Lock-free list of per-thread records. Records are never freed while the registry lives, a thread that exits gives its
+// record back so the next thread can reuse it (along with anything still retired in it).
+// Record must have `std::atomic<bool> inUse` and `Record* next` members.
+template<typename Record>
+class ThreadRecordRegistry {
+public:
+    ThreadRecordRegistry() = default;
+    ThreadRecordRegistry(const ThreadRecordRegistry&) = delete;
+    ThreadRecordRegistry& operator=(const ThreadRecordRegistry&) = delete;
+
+    ~ThreadRecordRegistry() {
+        Record* record = head.load();
+        while (record != nullptr) {
+            Record* next = record->next;
+            delete record;
+            record = next;
+        }
+    }
+
+    // Claims a free record, or creates and publishes a new one
+    Record* Acquire() {
+        for (Record* record = head.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+            bool expected = false;
+            if (!record->inUse.load(std::memory_order_relaxed) &&
+                record->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return record;
+            }
+        }
+
+        auto* record = new Record();
+        record->inUse.store(true, std::memory_order_relaxed);
+        Record* oldHead = head.load(std::memory_order_relaxed);
+        do {
+            record->next = oldHead;
+        } while (!head.compare_exchange_weak(oldHead, record, std::memory_order_release, std::memory_order_relaxed));
+        count.fetch_add(1, std::memory_order_relaxed);
+        return record;
+    }
+
+    void Release(Record* record) {
+        record->inUse.store(false, std::memory_order_release);
+    }
+
+    [[nodiscard]] Record* Head() const { return head.load(std::memory_order_acquire); }
+    [[nodiscard]] size_t Size() const { return count.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<Record*> head{nullptr};
+    std::atomic<size_t> count{0};
+};
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "ProducerParking.h"
+
+#include <atomic>
+#include <new>
+#include <string>
+
+// Single-producer single-consumer ring buffer (Lamport 1983). Only the producer writes tail and only the consumer writes
+// head, so neither side needs a CAS. Each side keeps a private copy of the other side's index and only reloads the
+// shared one when the copy says the buffer is full/empty, which keeps the two cache lines from bouncing on every call.
+template<class T, size_t bufferSize>
+class SPSCRingBufferQueue {
+    // Checks if bufferSize is a power of two, if it isn't prints message
+    static_assert((bufferSize & (bufferSize - 1)) == 0 && "bufferSize must be a power of two");
+public:
+    static std::string GetName() { return "SPSC Ring Buffer Queue (" + std::to_string(bufferSize) + " cells)"; }
+
+    // Only one thread may enqueue and only one thread may dequeue
+    static constexpr int maxProducers = 1;
+    static constexpr int maxConsumers = 1;
+
+    // Enqueue and Dequeue declaration, Enqueue waits for a free cell while the buffer is full (spins, then parks)
+    void Enqueue(const T& value);
+    bool Dequeue(T& out);
+
+    // Bulk Enqueue and Dequeue declaration, EnqueueBulk waits until every value is enqueued
+    void EnqueueBulk(const T* values, size_t count);
+    size_t DequeueBulk(T* out, size_t max);
+
+    // Never wait: TryEnqueue returns false if the buffer was full, TryEnqueueBulk returns how many of the values (from
+    // the front) were enqueued before it was
+    bool TryEnqueue(const T& value);
+    size_t TryEnqueueBulk(const T* values, size_t count);
+
+    // Wait like Enqueue/EnqueueBulk, but give up once running is false, so the producer can be stopped while the buffer
+    // is full. EnqueueWhile returns false if it gave up, EnqueueBulkWhile the number of values enqueued.
+    bool EnqueueWhile(const T& value, const std::atomic<bool>& running);
+    size_t EnqueueBulkWhile(const T* values, size_t count, const std::atomic<bool>& running);
+
+private:
+    static constexpr size_t bufferMask = bufferSize - 1;
+
+    // Consumer side
+    alignas(std::hardware_destructive_interference_size) std::atomic<size_t> head{0};
+    size_t cachedTail = 0;
+
+    // Producer side
+    alignas(std::hardware_destructive_interference_size) std::atomic<size_t> tail{0};
+    size_t cachedHead = 0;
+
+    // The producer waiting for a free cell, only written when it parks so the consumer's checks stay cache hits
+    alignas(std::hardware_destructive_interference_size) ProducerParking producerParking;
+
+    alignas(std::hardware_destructive_interference_size) T buffer[bufferSize];
+};
+
+// Enqueue implementation
+template<typename T, size_t bufferSize>
+void SPSCRingBufferQueue<T, bufferSize>::Enqueue(const T& value) {
+    producerParking.Wait([&] { return TryEnqueue(value); }, [] { return true; });
+}
+
+template<typename T, size_t bufferSize>
+bool SPSCRingBufferQueue<T, bufferSize>::EnqueueWhile(const T& value, const std::atomic<bool>& running) {
+    return producerParking.Wait([&] { return TryEnqueue(value); }, [&] { return running.load(std::memory_order_relaxed); });
+}
+
+template<typename T, size_t bufferSize>
+bool SPSCRingBufferQueue<T, bufferSize>::TryEnqueue(const T& value) {
+    size_t pos = tail.load(std::memory_order_relaxed);
+
+    if (pos - cachedHead == bufferSize) {
+        cachedHead = head.load(std::memory_order_acquire);
+        if (pos - cachedHead == bufferSize) {
+            // buffer is full
+            return false;
+        }
+    }
+
+    buffer[pos & bufferMask] = value;
+    tail.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+// Dequeue implementation
+template<typename T, size_t bufferSize>
+bool SPSCRingBufferQueue<T, bufferSize>::Dequeue(T& out) {
+    size_t pos = head.load(std::memory_order_relaxed);
+
+    if (pos == cachedTail) {
+        cachedTail = tail.load(std::memory_order_acquire);
+        if (pos == cachedTail) {
+            // queue is empty
+            return false;
+        }
+    }
+
+    out = buffer[pos & bufferMask];
+    head.store(pos + 1, std::memory_order_release);
+    producerParking.Notify();
+    return true;
+}
+
+// Bulk Enqueue implementation, publishes every value with a single store
+template<typename T, size_t bufferSize>
+void SPSCRingBufferQueue<T, bufferSize>::EnqueueBulk(const T* values, size_t count) {
+    size_t enqueued = 0;
+    producerParking.Wait([&] {
+        enqueued += TryEnqueueBulk(values + enqueued, count - enqueued);
+        return enqueued == count;
+    }, [] { return true; });
+}
+
+template<typename T, size_t bufferSize>
+size_t SPSCRingBufferQueue<T, bufferSize>::EnqueueBulkWhile(const T* values, size_t count, const std::atomic<bool>& running) {
+    size_t enqueued = 0;
+    producerParking.Wait([&] {
+        enqueued += TryEnqueueBulk(values + enqueued, count - enqueued);
+        return enqueued == count;
+    }, [&] { return running.load(std::memory_order_relaxed); });
+    return enqueued;
+}
+
+template<typename T, size_t bufferSize>
+size_t SPSCRingBufferQueue<T, bufferSize>::TryEnqueueBulk(const T* values, size_t count) {
+    size_t pos = tail.load(std::memory_order_relaxed);
+
+    size_t free = bufferSize - (pos - cachedHead);
+    if (free < count) {
+        cachedHead = head.load(std::memory_order_acquire);
+        free = bufferSize - (pos - cachedHead);
+    }
+
+    // only what fits is written, the caller finds the rest in the return value
+    size_t toWrite = count < free ? count : free;
+    for (size_t i = 0; i < toWrite; i++) {
+        buffer[(pos + i) & bufferMask] = values[i];
+    }
+    tail.store(pos + toWrite, std::memory_order_release);
+    return toWrite;
+}
+
+// Bulk Dequeue implementation, releases every cell with a single store
+template<typename T, size_t bufferSize>
+size_t SPSCRingBufferQueue<T, bufferSize>::DequeueBulk(T* out, size_t max) {
+    size_t pos = head.load(std::memory_order_relaxed);
+
+    size_t available = cachedTail - pos;
+    if (available < max) {
+        cachedTail = tail.load(std::memory_order_acquire);
+        available = cachedTail - pos;
+    }
+
+    size_t toRead = max < available ? max : available;
+    for (size_t i = 0; i < toRead; i++) {
+        out[i] = buffer[(pos + i) & bufferMask];
+    }
+    head.store(pos + toRead, std::memory_order_release);
+    if (toRead > 0) producerParking.Notify();
+    return toRead;
+}
\ No newline at end of file
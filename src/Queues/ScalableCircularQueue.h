@@ -0,0 +1,273 @@
+#pragma once
+
+#include "ProducerParking.h"
+#include "Layout/CellLayout.h"
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <string>
+
+// Scalable Circular Queue (Nikolaev 2019). Threads claim ring positions with fetch_add instead of a CAS on
+// enqueuePos/dequeuePos, so under contention every thread gets a position on its first try instead of retrying a
+// failed CAS, and CASes are only needed on the claimed entry itself. Unlike LCRQ it needs no double-width CAS.
+// The rings only hold indices: freeRing holds the indices of empty cells and readyRing those of filled ones, so an
+// enqueue takes an index from freeRing, writes its cell and puts the index into readyRing, and a dequeue does the
+// opposite.
+template<class T, size_t bufferSize>
+class ScalableCircularQueue {
+    // Checks if bufferSize is a power of two, if it isn't prints message
+    static_assert(bufferSize >= 2 && (bufferSize & (bufferSize - 1)) == 0 && "bufferSize must be a power of two");
+public:
+    static std::string GetName() { return "Scalable Circular Queue (" + std::to_string(bufferSize) + " cells)"; }
+
+    ScalableCircularQueue();
+
+    // Enqueue and Dequeue declaration, Enqueue waits for a free cell while the queue is full (spins, then parks)
+    void Enqueue(const T& value);
+    bool Dequeue(T& out);
+
+    // Bulk Enqueue and Dequeue declaration, each value still takes its own index, only the waiting is shared
+    void EnqueueBulk(const T* values, size_t count);
+    size_t DequeueBulk(T* out, size_t max);
+
+    // Never wait: TryEnqueue returns false if the queue was full, TryEnqueueBulk returns how many of the values (from
+    // the front) were enqueued before it was
+    bool TryEnqueue(const T& value);
+    size_t TryEnqueueBulk(const T* values, size_t count);
+
+    // Wait like Enqueue/EnqueueBulk, but give up once running is false, so producers can be stopped while the queue is
+    // full. EnqueueWhile returns false if it gave up, EnqueueBulkWhile the number of values enqueued.
+    bool EnqueueWhile(const T& value, const std::atomic<bool>& running);
+    size_t EnqueueBulkWhile(const T* values, size_t count, const std::atomic<bool>& running);
+
+private:
+    static constexpr unsigned log2(size_t powerOfTwo) {
+        unsigned result = 0;
+        while (powerOfTwo > 1) {
+            powerOfTwo >>= 1;
+            result++;
+        }
+        return result;
+    }
+
+    // Ring of up to bufferSize indices below bufferSize. It has twice as many entries as indices, which is what lets
+    // an enqueue always find an empty entry without a full check.
+    class IndexRing {
+    public:
+        IndexRing();
+
+        // Never fails as long as the ring holds fewer than bufferSize indices
+        void Enqueue(size_t index);
+        // Returns false if the ring was empty
+        bool Dequeue(size_t& index);
+
+    private:
+        static constexpr size_t ringSize = bufferSize * 2;
+        static constexpr size_t ringMask = ringSize - 1;
+        static constexpr unsigned ringLog2 = log2(ringSize);
+
+        // Each entry packs [cycle | isSafe | index], the cycle being which lap of the ring position it was written for
+        static constexpr unsigned indexBits = ringLog2;
+        static constexpr uint64_t indexMask = (uint64_t(1) << indexBits) - 1;
+        static constexpr uint64_t safeBit = uint64_t(1) << indexBits;
+        static constexpr unsigned cycleShift = indexBits + 1;
+        // An entry holding no index, bufferSize <= emptyIndex so no real index looks like it
+        static constexpr uint64_t emptyIndex = indexMask;
+
+        // Dequeues that may find nothing before the ring is known to be empty, reset by every enqueue
+        static constexpr int64_t emptyThreshold = (int64_t)(bufferSize + ringSize) - 1;
+
+        static uint64_t cycleOf(uint64_t position) { return position >> ringLog2; }
+        static uint64_t entryCycle(uint64_t entry) { return entry >> cycleShift; }
+        static uint64_t makeEntry(uint64_t cycle, bool isSafe, uint64_t index) {
+            return (cycle << cycleShift) | (isSafe ? safeBit : 0) | index;
+        }
+
+        // Consecutive positions land on different cache lines, so threads that claimed neighbouring positions don't
+        // fight over one line
+        std::atomic<uint64_t>& entryAt(uint64_t position) {
+            return entries[SwizzledCellLayout::Index<std::atomic<uint64_t>>(position, ringMask, ringLog2)];
+        }
+
+        // Moves tail up to head after dequeues overtook it, so later enqueues don't land behind head
+        void catchUp(uint64_t tailPos, uint64_t headPos);
+
+        alignas(std::hardware_destructive_interference_size) std::atomic<uint64_t> tail{ringSize};
+        alignas(std::hardware_destructive_interference_size) std::atomic<uint64_t> head{ringSize};
+        alignas(std::hardware_destructive_interference_size) std::atomic<int64_t> threshold{-1};
+        alignas(std::hardware_destructive_interference_size) std::atomic<uint64_t> entries[ringSize];
+    };
+
+    IndexRing freeRing;
+    IndexRing readyRing;
+
+    // Producers waiting for a free cell
+    alignas(std::hardware_destructive_interference_size) ProducerParking producerParking;
+
+    alignas(std::hardware_destructive_interference_size) T cells[bufferSize];
+};
+
+// Index ring, every entry starts empty and safe in cycle 0 while head and tail start in cycle 1
+template<typename T, size_t bufferSize>
+ScalableCircularQueue<T, bufferSize>::IndexRing::IndexRing() {
+    for (size_t i = 0; i < ringSize; i++) {
+        entries[i].store(makeEntry(0, true, emptyIndex), std::memory_order_relaxed);
+    }
+}
+
+template<typename T, size_t bufferSize>
+void ScalableCircularQueue<T, bufferSize>::IndexRing::Enqueue(size_t index) {
+    while (true) {
+        uint64_t tailPos = tail.fetch_add(1, std::memory_order_seq_cst);
+        uint64_t tailCycle = cycleOf(tailPos);
+        std::atomic<uint64_t>& slot = entryAt(tailPos);
+        uint64_t entry = slot.load(std::memory_order_acquire);
+
+        // the entry is usable if it is empty from an earlier lap, and either no dequeue gave up on it (isSafe) or no
+        // dequeue has reached this position yet
+        while (entryCycle(entry) < tailCycle && (entry & indexMask) == emptyIndex &&
+               ((entry & safeBit) || head.load(std::memory_order_seq_cst) <= tailPos)) {
+            if (slot.compare_exchange_weak(entry, makeEntry(tailCycle, true, index), std::memory_order_seq_cst, std::memory_order_acquire)) {
+                if (threshold.load(std::memory_order_relaxed) != emptyThreshold) {
+                    threshold.store(emptyThreshold, std::memory_order_seq_cst);
+                }
+                return;
+            }
+        }
+        // entry is taken or unsafe, try the next position
+    }
+}
+
+template<typename T, size_t bufferSize>
+bool ScalableCircularQueue<T, bufferSize>::IndexRing::Dequeue(size_t& index) {
+    // no enqueue since enough dequeues came up empty, skip touching head
+    if (threshold.load(std::memory_order_seq_cst) < 0) return false;
+
+    while (true) {
+        uint64_t headPos = head.fetch_add(1, std::memory_order_seq_cst);
+        uint64_t headCycle = cycleOf(headPos);
+        std::atomic<uint64_t>& slot = entryAt(headPos);
+        uint64_t entry = slot.load(std::memory_order_acquire);
+
+        while (true) {
+            uint64_t cycle = entryCycle(entry);
+            if (cycle == headCycle) {
+                // the entry was written for this position, take its index and mark it empty
+                slot.fetch_or(emptyIndex, std::memory_order_acq_rel);
+                index = entry & indexMask;
+                return true;
+            }
+            if (cycle >= headCycle) break;
+
+            // the enqueue for this position hasn't happened yet. An empty entry is moved to this cycle, so that late
+            // enqueue can't use it anymore, one still holding an index from the last lap is marked unsafe instead
+            uint64_t replacement = (entry & indexMask) == emptyIndex
+                    ? makeEntry(headCycle, entry & safeBit, emptyIndex)
+                    : makeEntry(cycle, false, entry & indexMask);
+            if (slot.compare_exchange_weak(entry, replacement, std::memory_order_seq_cst, std::memory_order_acquire)) break;
+        }
+
+        uint64_t tailPos = tail.load(std::memory_order_seq_cst);
+        if (tailPos <= headPos + 1) {
+            // head passed tail, the ring is empty
+            catchUp(tailPos, headPos + 1);
+            threshold.fetch_sub(1, std::memory_order_seq_cst);
+            return false;
+        }
+        if (threshold.fetch_sub(1, std::memory_order_seq_cst) <= 0) return false;
+    }
+}
+
+template<typename T, size_t bufferSize>
+void ScalableCircularQueue<T, bufferSize>::IndexRing::catchUp(uint64_t tailPos, uint64_t headPos) {
+    while (!tail.compare_exchange_weak(tailPos, headPos, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        headPos = head.load(std::memory_order_seq_cst);
+        tailPos = tail.load(std::memory_order_seq_cst);
+        if (tailPos >= headPos) break;
+    }
+}
+
+// Constructor, every cell starts free
+template<typename T, size_t bufferSize>
+ScalableCircularQueue<T, bufferSize>::ScalableCircularQueue() {
+    for (size_t i = 0; i < bufferSize; i++) {
+        freeRing.Enqueue(i);
+    }
+}
+
+// Enqueue implementation
+template<typename T, size_t bufferSize>
+void ScalableCircularQueue<T, bufferSize>::Enqueue(const T& value) {
+    producerParking.Wait([&] { return TryEnqueue(value); }, [] { return true; });
+}
+
+template<typename T, size_t bufferSize>
+bool ScalableCircularQueue<T, bufferSize>::EnqueueWhile(const T& value, const std::atomic<bool>& running) {
+    return producerParking.Wait([&] { return TryEnqueue(value); }, [&] { return running.load(std::memory_order_relaxed); });
+}
+
+template<typename T, size_t bufferSize>
+bool ScalableCircularQueue<T, bufferSize>::TryEnqueue(const T& value) {
+    size_t index;
+    if (!freeRing.Dequeue(index)) {
+        // every cell is filled
+        return false;
+    }
+    cells[index] = value;
+    readyRing.Enqueue(index);
+    return true;
+}
+
+// Dequeue implementation
+template<typename T, size_t bufferSize>
+bool ScalableCircularQueue<T, bufferSize>::Dequeue(T& out) {
+    size_t index;
+    if (!readyRing.Dequeue(index)) {
+        // queue is empty
+        return false;
+    }
+    out = cells[index];
+    freeRing.Enqueue(index);
+    producerParking.Notify();
+    return true;
+}
+
+// Bulk Enqueue implementation
+template<typename T, size_t bufferSize>
+void ScalableCircularQueue<T, bufferSize>::EnqueueBulk(const T* values, size_t count) {
+    size_t enqueued = 0;
+    producerParking.Wait([&] {
+        enqueued += TryEnqueueBulk(values + enqueued, count - enqueued);
+        return enqueued == count;
+    }, [] { return true; });
+}
+
+template<typename T, size_t bufferSize>
+size_t ScalableCircularQueue<T, bufferSize>::EnqueueBulkWhile(const T* values, size_t count, const std::atomic<bool>& running) {
+    size_t enqueued = 0;
+    producerParking.Wait([&] {
+        enqueued += TryEnqueueBulk(values + enqueued, count - enqueued);
+        return enqueued == count;
+    }, [&] { return running.load(std::memory_order_relaxed); });
+    return enqueued;
+}
+
+template<typename T, size_t bufferSize>
+size_t ScalableCircularQueue<T, bufferSize>::TryEnqueueBulk(const T* values, size_t count) {
+    size_t enqueued = 0;
+    while (enqueued < count && TryEnqueue(values[enqueued])) {
+        enqueued++;
+    }
+    return enqueued;
+}
+
+// Bulk Dequeue implementation
+template<typename T, size_t bufferSize>
+size_t ScalableCircularQueue<T, bufferSize>::DequeueBulk(T* out, size_t max) {
+    size_t dequeued = 0;
+    while (dequeued < max && Dequeue(out[dequeued])) {
+        dequeued++;
+    }
+    return dequeued;
+}
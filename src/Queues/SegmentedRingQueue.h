@@ -0,0 +1,267 @@
+#pragma once
+
+#include "Reclamation/HazardPointerReclaimer.h"
+#include "Allocation/ThreadCachingNodePool.h"
+
+#include <atomic>
+#include <new>
+#include <string>
+
+// Unbounded queue made of a linked list of bounded rings (like LCRQ's list of CRQs, with the circular buffer's rings).
+// While consumers keep up, everything happens in one ring that keeps wrapping around, like BoundedCircularBufferQueue.
+// When that ring fills up it is closed to producers and a new ring is linked after it, so enqueues never wait or drop.
+// Consumers drain the closed ring, then move on and retire it.
+// ReclaimerT decides when drained rings are freed, since other threads may still be reading them (see Reclamation/)
+// AllocatorT decides where rings come from and go back to (see Allocation/), the node pool recycles them
+template<typename T, size_t blockSize = 256, typename ReclaimerT = HazardPointerReclaimer, typename AllocatorT = ThreadCachingNodePool>
+class SegmentedRingQueue {
+    // Checks if blockSize is a power of two, if it isn't prints message
+    static_assert(blockSize >= 2 && (blockSize & (blockSize - 1)) == 0 && "blockSize must be a power of two");
+private:
+    static constexpr size_t blockMask = blockSize - 1;
+    // Set in a block's enqueuePos once it is closed, after which its enqueuePos never changes
+    static constexpr size_t closedBit = size_t(1) << (sizeof(size_t) * 8 - 1);
+
+    // One ring, same cells as BoundedCircularBufferQueue
+    struct Block {
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        alignas(std::hardware_destructive_interference_size) std::atomic<size_t> enqueuePos{0};
+        alignas(std::hardware_destructive_interference_size) std::atomic<size_t> dequeuePos{0};
+        alignas(std::hardware_destructive_interference_size) std::atomic<Block*> next{nullptr};
+        alignas(std::hardware_destructive_interference_size) Cell cells[blockSize];
+
+        Block() {
+            for (size_t i = 0; i < blockSize; i++) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        // A new block holding value, so the producer that links it has already enqueued
+        explicit Block(const T& value) : Block() {
+            cells[0].data = value;
+            cells[0].sequence.store(1, std::memory_order_relaxed);
+            enqueuePos.store(1, std::memory_order_relaxed);
+        }
+
+        // Returns false if the block is closed, closes it first if it is full
+        bool TryEnqueue(const T& value);
+        // Returns false if the block looked empty
+        bool TryDequeue(T& out);
+
+        // Every value enqueued into this closed block has been claimed by a consumer
+        bool IsDrained() const {
+            return dequeuePos.load(std::memory_order_acquire) == (enqueuePos.load(std::memory_order_acquire) & ~closedBit);
+        }
+    };
+
+    static Block* newBlock(const T& value) {
+        return AllocatorT::template New<Block>(value);
+    }
+
+    static void deleteBlock(void* block) {
+        AllocatorT::Delete(static_cast<Block*>(block));
+    }
+
+    // Enqueue into the tail block, linking a new one if it is closed. The caller's guard protects slot 0.
+    void enqueue(typename ReclaimerT::Guard& guard, const T& value);
+    // Dequeue from the head block, moving on to the next one once it is drained. The caller's guard protects slot 0.
+    bool dequeue(typename ReclaimerT::Guard& guard, T& out);
+
+    alignas(std::hardware_destructive_interference_size) std::atomic<Block*> head;
+    alignas(std::hardware_destructive_interference_size) std::atomic<Block*> tail;
+
+public:
+    using Reclaimer = ReclaimerT;
+    static constexpr size_t nodeSize = sizeof(Block);
+
+    static std::string GetName() {
+        return "Segmented Ring Queue (" + std::to_string(blockSize) + " cell blocks, " + ReclaimerT::GetName() + ", " + AllocatorT::GetName() + ")";
+    }
+
+    // Constructor and Deconstructor
+    SegmentedRingQueue() {
+        Block* block = AllocatorT::template New<Block>();
+        head.store(block);
+        tail.store(block);
+    }
+    ~SegmentedRingQueue() {
+        Block* block = head.load();
+        while (block != nullptr) {
+            Block* next = block->next.load();
+            deleteBlock(block);
+            block = next;
+        }
+    }
+
+    // Enqueue and Dequeue declaration, Enqueue never waits or drops
+    void Enqueue(const T& value) {
+        typename ReclaimerT::Guard guard;
+        enqueue(guard, value);
+    }
+    bool Dequeue(T& out) {
+        typename ReclaimerT::Guard guard;
+        return dequeue(guard, out);
+    }
+
+    // Bulk Enqueue and Dequeue declaration, each value takes its own cell but the whole call shares one guard
+    void EnqueueBulk(const T* values, size_t count) {
+        typename ReclaimerT::Guard guard;
+        for (size_t i = 0; i < count; i++) {
+            enqueue(guard, values[i]);
+        }
+    }
+    size_t DequeueBulk(T* out, size_t max) {
+        typename ReclaimerT::Guard guard;
+        size_t dequeued = 0;
+        while (dequeued < max && dequeue(guard, out[dequeued])) {
+            dequeued++;
+        }
+        return dequeued;
+    }
+
+    // Holds the thread's reclamation record, so guards made with a token skip looking it up
+    class Token {
+    public:
+        explicit Token(SegmentedRingQueue&) { }
+    private:
+        friend class SegmentedRingQueue;
+        typename ReclaimerT::Local local;
+    };
+    using ProducerToken = Token;
+    using ConsumerToken = Token;
+
+    void Enqueue(Token& token, const T& value) {
+        typename ReclaimerT::Guard guard(token.local);
+        enqueue(guard, value);
+    }
+    bool Dequeue(Token& token, T& out) {
+        typename ReclaimerT::Guard guard(token.local);
+        return dequeue(guard, out);
+    }
+    void EnqueueBulk(Token& token, const T* values, size_t count) {
+        typename ReclaimerT::Guard guard(token.local);
+        for (size_t i = 0; i < count; i++) {
+            enqueue(guard, values[i]);
+        }
+    }
+    size_t DequeueBulk(Token& token, T* out, size_t max) {
+        typename ReclaimerT::Guard guard(token.local);
+        size_t dequeued = 0;
+        while (dequeued < max && dequeue(guard, out[dequeued])) {
+            dequeued++;
+        }
+        return dequeued;
+    }
+};
+
+// Block Enqueue implementation, the circular buffer's enqueue except that a full block is closed instead of waited on
+template<typename T, size_t blockSize, typename ReclaimerT, typename AllocatorT>
+bool SegmentedRingQueue<T, blockSize, ReclaimerT, AllocatorT>::Block::TryEnqueue(const T& value) {
+    Cell* cell;
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+
+    while (true) {
+        if (pos & closedBit) return false;
+
+        cell = &cells[pos & blockMask];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+        if (diff == 0) {
+            // closing sets a bit in enqueuePos, so this fails if the block was closed since pos was read
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // block is full, close it so every producer moves on to the next one
+            pos = enqueuePos.fetch_or(closedBit, std::memory_order_acq_rel) | closedBit;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->data = value;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+// Block Dequeue implementation, same as the circular buffer's
+template<typename T, size_t blockSize, typename ReclaimerT, typename AllocatorT>
+bool SegmentedRingQueue<T, blockSize, ReclaimerT, AllocatorT>::Block::TryDequeue(T& out) {
+    Cell* cell;
+    size_t pos = dequeuePos.load(std::memory_order_relaxed);
+
+    while (true) {
+        cell = &cells[pos & blockMask];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+
+        if (diff == 0) {
+            if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // block is empty, or the next value's producer hasn't finished writing it
+            return false;
+        } else {
+            pos = dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    out = cell->data;
+    cell->sequence.store(pos + blockMask + 1, std::memory_order_release);
+    return true;
+}
+
+// Enqueue implementation
+template<typename T, size_t blockSize, typename ReclaimerT, typename AllocatorT>
+void SegmentedRingQueue<T, blockSize, ReclaimerT, AllocatorT>::enqueue(typename ReclaimerT::Guard& guard, const T& value) {
+    while (true) {
+        Block* last = guard.Protect(0, tail);
+        if (last->TryEnqueue(value)) return;
+
+        // last is closed, move tail on or link a new block holding value
+        Block* next = last->next.load();
+        if (next != nullptr) {
+            tail.compare_exchange_weak(last, next);
+            continue;
+        }
+
+        Block* block = newBlock(value);
+        if (last->next.compare_exchange_strong(next, block)) {
+            tail.compare_exchange_strong(last, block);
+            return;
+        }
+        // another producer linked its block first, this one was never visible
+        deleteBlock(block);
+        tail.compare_exchange_weak(last, next);
+    }
+}
+
+// Dequeue implementation
+template<typename T, size_t blockSize, typename ReclaimerT, typename AllocatorT>
+bool SegmentedRingQueue<T, blockSize, ReclaimerT, AllocatorT>::dequeue(typename ReclaimerT::Guard& guard, T& out) {
+    while (true) {
+        Block* first = guard.Protect(0, head);
+        if (first->TryDequeue(out)) return true;
+
+        // a block only gets a next once it is closed, so without one the queue is empty
+        Block* next = first->next.load();
+        if (next == nullptr) return false;
+
+        // a producer that claimed a cell hasn't written it yet, its value is still to come from this block
+        if (!first->IsDrained()) return false;
+
+        // the tail may not have been moved past first yet, and must be before first is retired
+        Block* last = tail.load();
+        if (last == first) tail.compare_exchange_strong(last, next);
+
+        if (head.compare_exchange_strong(first, next)) {
+            ReclaimerT::Retire(first, &deleteBlock);
+        }
+    }
+}
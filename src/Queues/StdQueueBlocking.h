@@ -1,34 +1,62 @@
 #pragma once
 
-#include <IQueue.h>
+#include "Locks/MutexLock.h"
 
 #include <mutex>
 #include <queue>
+#include <string>
+#include <type_traits>
 
-template<typename T>
-class StdQueueBlocking : public IQueue<T> {
+// LockT guards the queue (see Locks/)
+template<typename T, typename LockT = MutexLock>
+class StdQueueBlocking {
 public:
-    static std::string GetName() { return "std::queue (Blocking)"; }
+    static std::string GetName() {
+        if constexpr (std::is_same_v<LockT, MutexLock>) return "std::queue (Blocking)";
+        else return "std::queue (Blocking, " + LockT::GetName() + ")";
+    }
 
-    void Enqueue(const T& value) override;
-    bool Dequeue(T& out) override;
+    void Enqueue(const T& value);
+    bool Dequeue(T& out);
+
+    void EnqueueBulk(const T* values, size_t count);
+    size_t DequeueBulk(T* out, size_t max);
 
 private:
     std::queue<T> queue;
-    std::mutex mutex;
+    LockT mutex;
 };
 
-template<typename T>
-void StdQueueBlocking<T>::Enqueue(const T& value) {
+template<typename T, typename LockT>
+void StdQueueBlocking<T, LockT>::Enqueue(const T& value) {
     std::lock_guard lock(mutex);
     queue.push(value);
 }
 
-template<typename T>
-bool StdQueueBlocking<T>::Dequeue(T& out) {
+template<typename T, typename LockT>
+bool StdQueueBlocking<T, LockT>::Dequeue(T& out) {
     std::lock_guard lock(mutex);
     if (queue.empty()) return false;
     out = queue.front();
     queue.pop();
     return true;
 }
+
+template<typename T, typename LockT>
+void StdQueueBlocking<T, LockT>::EnqueueBulk(const T* values, size_t count) {
+    std::lock_guard lock(mutex);
+    for (size_t i = 0; i < count; i++) {
+        queue.push(values[i]);
+    }
+}
+
+template<typename T, typename LockT>
+size_t StdQueueBlocking<T, LockT>::DequeueBulk(T* out, size_t max) {
+    std::lock_guard lock(mutex);
+    size_t count = 0;
+    while (count < max && !queue.empty()) {
+        out[count++] = queue.front();
+        queue.pop();
+    }
+    return count;
+}
@@ -1,17 +1,19 @@
 #pragma once
 
-#include <IQueue.h>
-
 #include <queue>
 
 template<typename T>
-class StdQueueUnsafe : public IQueue<T> {
+class StdQueueUnsafe {
 public:
     static std::string GetName() { return "std::queue (Unsafe)"; }
 
     // Function declarations for enqueue and dequeue
-    void Enqueue(const T& value) override;
-    bool Dequeue(T& out) override;
+    void Enqueue(const T& value);
+    bool Dequeue(T& out);
+
+    // Function declarations for bulk enqueue and dequeue
+    void EnqueueBulk(const T* values, size_t count);
+    size_t DequeueBulk(T* out, size_t max);
 
 private:
     std::queue<T> queue;
@@ -32,3 +34,22 @@ bool StdQueueUnsafe<T>::Dequeue(T& out) {
     return true;
 }
 
+// Function definition for bulk enqueue
+template<typename T>
+void StdQueueUnsafe<T>::EnqueueBulk(const T* values, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        queue.push(values[i]);
+    }
+}
+
+// Function definition for bulk dequeue
+template<typename T>
+size_t StdQueueUnsafe<T>::DequeueBulk(T* out, size_t max) {
+    size_t count = 0;
+    while (count < max && !queue.empty()) {
+        out[count++] = queue.front();
+        queue.pop();
+    }
+    return count;
+}
+
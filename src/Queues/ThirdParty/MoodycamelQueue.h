@@ -1,18 +1,42 @@
 #pragma once
 
-#include <IQueue.h>
-
 #include "concurrentqueue.h"
 
 #include <string>
 
 template<typename T>
-class MoodycamelQueue : public IQueue<T> {
+class MoodycamelQueue {
 public:
     static std::string GetName() { return "moodycamel::ConcurrentQueue"; }
 
-    void Enqueue(const T& value) override;
-    bool Dequeue(T& out) override;
+    void Enqueue(const T& value);
+    bool Dequeue(T& out);
+
+    void EnqueueBulk(const T* values, size_t count);
+    size_t DequeueBulk(T* out, size_t max);
+
+    // moodycamel's tokens: a ProducerToken gives the thread its own sub-queue instead of finding its implicit one by
+    // thread id on every enqueue, a ConsumerToken remembers which sub-queue the thread last dequeued from
+    class ProducerToken {
+    public:
+        explicit ProducerToken(MoodycamelQueue& queue) : token(queue.queue) { }
+    private:
+        friend class MoodycamelQueue;
+        moodycamel::ProducerToken token;
+    };
+    class ConsumerToken {
+    public:
+        explicit ConsumerToken(MoodycamelQueue& queue) : token(queue.queue) { }
+    private:
+        friend class MoodycamelQueue;
+        moodycamel::ConsumerToken token;
+    };
+
+    void Enqueue(ProducerToken& token, const T& value);
+    bool Dequeue(ConsumerToken& token, T& out);
+
+    void EnqueueBulk(ProducerToken& token, const T* values, size_t count);
+    size_t DequeueBulk(ConsumerToken& token, T* out, size_t max);
 
 private:
     moodycamel::ConcurrentQueue<T> queue;
@@ -27,3 +51,34 @@ template<typename T>
 bool MoodycamelQueue<T>::Dequeue(T& out) {
     return queue.try_dequeue(out);
 }
+
+
+template<typename T>
+void MoodycamelQueue<T>::EnqueueBulk(const T* values, size_t count) {
+    queue.enqueue_bulk(values, count);
+}
+
+template<typename T>
+size_t MoodycamelQueue<T>::DequeueBulk(T* out, size_t max) {
+    return queue.try_dequeue_bulk(out, max);
+}
+
+template<typename T>
+void MoodycamelQueue<T>::Enqueue(ProducerToken& token, const T& value) {
+    queue.enqueue(token.token, value);
+}
+
+template<typename T>
+bool MoodycamelQueue<T>::Dequeue(ConsumerToken& token, T& out) {
+    return queue.try_dequeue(token.token, out);
+}
+
+template<typename T>
+void MoodycamelQueue<T>::EnqueueBulk(ProducerToken& token, const T* values, size_t count) {
+    queue.enqueue_bulk(token.token, values, count);
+}
+
+template<typename T>
+size_t MoodycamelQueue<T>::DequeueBulk(ConsumerToken& token, T* out, size_t max) {
+    return queue.try_dequeue_bulk(token.token, out, max);
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "Locks/MutexLock.h"
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <string>
+
+// Two-lock queue (Michael & Scott 1996, the blocking algorithm from the same paper as LinkedListQueue). A linked list
+// with a dummy node, where producers only take the tail lock and consumers only the head lock, so unlike
+// StdQueueBlocking an enqueue and a dequeue never wait for each other.
+// LockT is the lock used for both ends (see Locks/)
+template<typename T, typename LockT = MutexLock>
+class TwoLockQueue {
+private:
+    struct Node {
+        T data;
+        // written by a producer while a consumer may be reading it, when the queue holds only the dummy node
+        std::atomic<Node*> next{nullptr};
+        Node() = default;
+        explicit Node(const T& data) : data(data) {}
+    };
+
+public:
+    static std::string GetName() { return "Two-Lock Queue (" + LockT::GetName() + ")"; }
+
+    // Constructor and Deconstructor
+    TwoLockQueue() {
+        Node* dummy = new Node();
+        head = dummy;
+        tail = dummy;
+    }
+    ~TwoLockQueue() {
+        Node* node = head;
+        while (node != nullptr) {
+            Node* next = node->next.load(std::memory_order_relaxed);
+            delete node;
+            node = next;
+        }
+    }
+
+    // Enqueue function, the node is allocated before taking the lock
+    void Enqueue(const T& value) {
+        Node* node = new Node(value);
+        std::lock_guard lock(tailLock);
+        tail->next.store(node, std::memory_order_release);
+        tail = node;
+    }
+
+    // Dequeue function, the old dummy node is freed after releasing the lock
+    bool Dequeue(T& out) {
+        Node* first;
+        {
+            std::lock_guard lock(headLock);
+            first = head;
+            Node* next = first->next.load(std::memory_order_acquire);
+            if (next == nullptr) {
+                return false;
+            }
+            out = next->data;
+            head = next;
+        }
+        delete first;
+        return true;
+    }
+
+    // Bulk Enqueue function, links the values into a private chain and splices it on under one lock
+    void EnqueueBulk(const T* values, size_t count) {
+        if (count == 0) return;
+
+        Node* chainHead = new Node(values[0]);
+        Node* chainTail = chainHead;
+        for (size_t i = 1; i < count; i++) {
+            Node* node = new Node(values[i]);
+            chainTail->next.store(node, std::memory_order_relaxed);
+            chainTail = node;
+        }
+
+        std::lock_guard lock(tailLock);
+        tail->next.store(chainHead, std::memory_order_release);
+        tail = chainTail;
+    }
+
+    // Bulk Dequeue function, unlinks up to max nodes under one lock
+    size_t DequeueBulk(T* out, size_t max) {
+        if (max == 0) return 0;
+
+        Node* first;
+        size_t count = 0;
+        {
+            std::lock_guard lock(headLock);
+            first = head;
+            Node* node = first;
+            while (count < max) {
+                Node* next = node->next.load(std::memory_order_acquire);
+                if (next == nullptr) break;
+                out[count++] = next->data;
+                node = next;
+            }
+            head = node;
+        }
+
+        // free the old dummy node and every node that was passed over, the new head stays as the dummy
+        for (size_t i = 0; i < count; i++) {
+            Node* next = first->next.load(std::memory_order_relaxed);
+            delete first;
+            first = next;
+        }
+        return count;
+    }
+
+private:
+    // Consumer side
+    alignas(std::hardware_destructive_interference_size) LockT headLock;
+    Node* head;
+
+    // Producer side
+    alignas(std::hardware_destructive_interference_size) LockT tailLock;
+    Node* tail;
+};
@@ -1,13 +1,38 @@
 #include "Evaluation/Benchmark.h"
 
 #include "Queues/LinkedListQueue.h"
+#include "Queues/Reclamation/EpochReclaimer.h"
+#include "Queues/Reclamation/HazardPointerReclaimer.h"
+#include "Queues/Reclamation/ImmediateReclaimer.h"
+#include "Queues/Allocation/ThreadCachingNodePool.h"
+#include "Evaluation/Wait/SpinWaitStrategy.h"
+#include "Evaluation/Wait/BackoffWaitStrategy.h"
+#include "Evaluation/Wait/YieldWaitStrategy.h"
+#include "Evaluation/Wait/ParkingWaitStrategy.h"
+#include "Evaluation/Completion/SharedCounterCompletion.h"
 #include "Queues/BoundedCircularBuffer.h"
+#include "Queues/SPSCRingBuffer.h"
+#include "Queues/ScalableCircularQueue.h"
+#include "Queues/SegmentedRingQueue.h"
+#include "Queues/IntrusiveMPSCQueue.h"
 #include "Queues/ThirdParty/MoodycamelQueue.h"
 #include "Queues/StdQueueBlocking.h"
+#include "Queues/FlatCombiningQueue.h"
+#include "Queues/TwoLockQueue.h"
+#include "Queues/Locks/TTASSpinLock.h"
+#include "Queues/Locks/TicketLock.h"
+#include "Queues/Locks/MCSLock.h"
+#include "Evaluation/QueueRegistry.h"
+#include "Evaluation/SampleStats.h"
+#include "Evaluation/VirtualDispatch.h"
+#include "Evaluation/Jobs/Pools/NoOpJobPool.h"
+#include "Configuration/CommandLine.h"
+#include "Configuration/SuiteFile.h"
 #include "Config.h"
 
 #include <fstream>
 #include <filesystem>
+#include <map>
 
 // Returns a string that shows a number of jobs in shorthand
 std::string formatJobCount(size_t count) {
@@ -87,55 +112,256 @@ void writeCsv(const std::string& path, const std::array<std::string, sizeof...(A
     file.close();
 }
 
+// Queue ids suites can refer to. Add a queue type here to make it selectable from the command line and config files.
+QueueRegistry registerQueues() {
+    QueueRegistry registry;
+    registry.Add<LinkedListQueue<Job*>>("linked_list");
+    registry.Add<BoundedCircularBufferQueue<Job*, 4>>("circular_buffer_4");
+    registry.Add<BoundedCircularBufferQueue<Job*, 16>>("circular_buffer_16");
+    registry.Add<BoundedCircularBufferQueue<Job*, runtimeCapacity>>("circular_buffer_runtime");
+    registry.Add<BoundedCircularBufferQueue<Job*, runtimeCapacity, HugePageBufferMemory>>("circular_buffer_runtime_huge");
+    registry.Add<BoundedCircularBufferQueue<Job*, 16, HeapBufferMemory, PaddedCellLayout>>("circular_buffer_16_padded");
+    registry.Add<BoundedCircularBufferQueue<Job*, 16, HeapBufferMemory, SwizzledCellLayout>>("circular_buffer_16_swizzled");
+    registry.Add<BoundedCircularBufferQueue<Job*, runtimeCapacity, HeapBufferMemory, PaddedCellLayout>>("circular_buffer_runtime_padded");
+    registry.Add<BoundedCircularBufferQueue<Job*, runtimeCapacity, HeapBufferMemory, SwizzledCellLayout>>("circular_buffer_runtime_swizzled");
+    registry.Add<ScalableCircularQueue<Job*, 16>>("scq_16");
+    registry.Add<ScalableCircularQueue<Job*, 1024>>("scq_1024");
+    registry.Add<SegmentedRingQueue<Job*>>("segmented_ring");
+    registry.Add<SPSCRingBufferQueue<Job*, 16>>("spsc_ring_16");
+    registry.Add<IntrusiveMPSCQueue<Job*>>("intrusive_mpsc");
+    registry.Add<MoodycamelQueue<Job*>>("moodycamel");
+    registry.Add<StdQueueBlocking<Job*>>("std_queue_blocking");
+    registry.Add<FlatCombiningQueue<Job*>>("flat_combining");
+    registry.Add<WorkStealing<IntrusiveMPSCQueue<Job*>>>("work_stealing_intrusive_mpsc");
+    registry.Add<WorkStealing<MoodycamelQueue<Job*>>>("work_stealing_moodycamel");
+
+    // memory reclamation and node allocation policies, "linked_list" is hazard pointers with the heap allocator and
+    // "segmented_ring" hazard pointers with 256 cell blocks from the node pool
+    registry.Add<LinkedListQueue<Job*, ImmediateReclaimer>>("linked_list_immediate");
+    registry.Add<LinkedListQueue<Job*, EpochReclaimer>>("linked_list_epoch");
+    registry.Add<LinkedListQueue<Job*, HazardPointerReclaimer, ThreadCachingNodePool>>("linked_list_pool");
+    registry.Add<LinkedListQueue<Job*, EpochReclaimer, ThreadCachingNodePool>>("linked_list_epoch_pool");
+    registry.Add<SegmentedRingQueue<Job*, 16>>("segmented_ring_16");
+    registry.Add<SegmentedRingQueue<Job*, 256, HazardPointerReclaimer, HeapNodeAllocator>>("segmented_ring_heap");
+
+    // lock choice vs lock design: one lock around std::queue vs separate head and tail locks, each with every lock
+    registry.Add<StdQueueBlocking<Job*, TTASSpinLock>>("std_queue_blocking_ttas");
+    registry.Add<StdQueueBlocking<Job*, TicketLock>>("std_queue_blocking_ticket");
+    registry.Add<StdQueueBlocking<Job*, MCSLock>>("std_queue_blocking_mcs");
+    registry.Add<TwoLockQueue<Job*>>("two_lock");
+    registry.Add<TwoLockQueue<Job*, TTASSpinLock>>("two_lock_ttas");
+    registry.Add<TwoLockQueue<Job*, TicketLock>>("two_lock_ticket");
+    registry.Add<TwoLockQueue<Job*, MCSLock>>("two_lock_mcs");
+
+    // bounded queues dropping jobs when full, how they behaved before Enqueue waited for room
+    registry.Add<DropWhenFull<BoundedCircularBufferQueue<Job*, 4>>>("circular_buffer_4_drop");
+    registry.Add<DropWhenFull<BoundedCircularBufferQueue<Job*, 16>>>("circular_buffer_16_drop");
+    registry.Add<DropWhenFull<SPSCRingBufferQueue<Job*, 16>>>("spsc_ring_16_drop");
+
+    // the same queues called through IQueue's virtual functions
+    registry.Add<VirtualDispatch<LinkedListQueue<Job*>>>("linked_list_virtual");
+    registry.Add<VirtualDispatch<BoundedCircularBufferQueue<Job*, 4>>>("circular_buffer_4_virtual");
+    registry.Add<VirtualDispatch<BoundedCircularBufferQueue<Job*, 16>>>("circular_buffer_16_virtual");
+    registry.Add<VirtualDispatch<ScalableCircularQueue<Job*, 16>>>("scq_16_virtual");
+    registry.Add<VirtualDispatch<SPSCRingBufferQueue<Job*, 16>>>("spsc_ring_16_virtual");
+    registry.Add<VirtualDispatch<IntrusiveMPSCQueue<Job*>>>("intrusive_mpsc_virtual");
+    registry.Add<VirtualDispatch<MoodycamelQueue<Job*>>>("moodycamel_virtual");
+    registry.Add<VirtualDispatch<StdQueueBlocking<Job*>>>("std_queue_blocking_virtual");
+
+    // queues with tokens, called without them
+    registry.Add<WithoutTokens<MoodycamelQueue<Job*>>>("moodycamel_no_tokens");
+    registry.Add<WithoutTokens<FlatCombiningQueue<Job*>>>("flat_combining_no_tokens");
+    registry.Add<WithoutTokens<SegmentedRingQueue<Job*>>>("segmented_ring_no_tokens");
+    registry.Add<WithoutTokens<LinkedListQueue<Job*>>>("linked_list_no_tokens");
+
+    registry.Add<WithWaitStrategy<BoundedCircularBufferQueue<Job*, 16>, SpinWaitStrategy>>("circular_buffer_16_spin");
+    registry.Add<WithWaitStrategy<BoundedCircularBufferQueue<Job*, 16>, BackoffWaitStrategy>>("circular_buffer_16_backoff");
+    registry.Add<WithWaitStrategy<BoundedCircularBufferQueue<Job*, 16>, YieldWaitStrategy>>("circular_buffer_16_yield");
+    registry.Add<WithWaitStrategy<BoundedCircularBufferQueue<Job*, 16>, ParkingWaitStrategy>>("circular_buffer_16_park");
+    registry.Add<WithWaitStrategy<MoodycamelQueue<Job*>, SpinWaitStrategy>>("moodycamel_spin");
+    registry.Add<WithWaitStrategy<MoodycamelQueue<Job*>, BackoffWaitStrategy>>("moodycamel_backoff");
+    registry.Add<WithWaitStrategy<MoodycamelQueue<Job*>, YieldWaitStrategy>>("moodycamel_yield");
+    registry.Add<WithWaitStrategy<MoodycamelQueue<Job*>, ParkingWaitStrategy>>("moodycamel_park");
+
+    registry.Add<WithCompletion<LinkedListQueue<Job*>, SharedCounterCompletion>>("linked_list_shared_completion");
+    registry.Add<WithCompletion<LinkedListQueue<Job*>, PerConsumerCompletion>>("linked_list_per_consumer_completion");
+    registry.Add<WithCompletion<BoundedCircularBufferQueue<Job*, 16>, SharedCounterCompletion>>("circular_buffer_16_shared_completion");
+    registry.Add<WithCompletion<BoundedCircularBufferQueue<Job*, 16>, PerConsumerCompletion>>("circular_buffer_16_per_consumer_completion");
+    registry.Add<WithCompletion<MoodycamelQueue<Job*>, SharedCounterCompletion>>("moodycamel_shared_completion");
+    registry.Add<WithCompletion<MoodycamelQueue<Job*>, PerConsumerCompletion>>("moodycamel_per_consumer_completion");
+    registry.Add<WithCompletion<StdQueueBlocking<Job*>, SharedCounterCompletion>>("std_queue_blocking_shared_completion");
+    registry.Add<WithCompletion<StdQueueBlocking<Job*>, PerConsumerCompletion>>("std_queue_blocking_per_consumer_completion");
+    return registry;
+}
+
+// Job pools suites can refer to by name
+const std::map<std::string, JobPoolFactory>& jobPoolFactories() {
+    static const std::map<std::string, JobPoolFactory> factories {
+        { "default", createDefaultJobPool },
+        { "noop", createNoOpJobPool },
+    };
+    return factories;
+}
+
+// A queue as it appears in the results, queues with a runtime capacity appear once per capacity of the suite
+struct QueueRun {
+    const QueueRegistration* queue;
+    std::string name;
+    size_t capacity; // 0 for the queue's default
+};
+
+std::vector<QueueRun> expandCapacities(const std::vector<const QueueRegistration*>& queues, const BenchmarkSuiteConfig& config) {
+    std::vector<QueueRun> runs;
+    for (const QueueRegistration* queue : queues) {
+        if (!queue->hasRuntimeCapacity || config.capacities.empty()) {
+            runs.push_back({ queue, queue->name, 0 });
+            continue;
+        }
+        for (size_t capacity : config.capacities) {
+            runs.push_back({ queue, queue->name + " [" + std::to_string(capacity) + " cells]", capacity });
+        }
+    }
+    return runs;
+}
+
+// Runs one configuration's iterations: config.warmupIterations unmeasured ones, then config.iterations measured ones,
+// then more (up to config.maxIterations) while the 95% confidence interval of the samples is wider than
+// ±targetConfidence of their mean. runIteration(measured) runs one iteration, prints its results and returns its
+// sample, callers discard everything else a warmup (measured = false) returns.
+template<typename RunIteration>
+SampleStats runIterations(const std::string& tag, const BenchmarkSuiteConfig& config, RunIteration runIteration) {
+    for (int warmup = 1; warmup <= config.warmupIterations; warmup++) {
+        std::cout << tag << "   Warmup " << warmup << "/" << config.warmupIterations << "...";
+        runIteration(false);
+    }
+
+    SampleStats stats;
+    for (int iteration = 1; iteration <= config.iterations || (iteration <= config.maxIterations && !stats.IsWithin(config.targetConfidence)); iteration++) {
+        if (iteration <= config.iterations) {
+            std::cout << tag << "   Iteration " << iteration << "/" << config.iterations << "...";
+        } else {
+            std::cout << tag << "   Iteration " << iteration << "/" << config.maxIterations << " (95% CI ±"
+                      << 100.0 * stats.GetConfidenceInterval() / stats.GetMean() << "%)...";
+        }
+        stats.Add(runIteration(true));
+    }
+    return stats;
+}
+
+// Calls f with every measured iteration's result that stats kept, and returns how many that was. results holds the
+// measured iterations in the order their samples were added, so the other columns average the same iterations as the
+// sample columns.
+template<typename Result, typename F>
+size_t forEachKept(const SampleStats& stats, const std::vector<Result>& results, F f) {
+    size_t kept = 0;
+    for (size_t i = 0; i < results.size(); i++) {
+        if (stats.IsOutlier(i)) continue;
+        f(results[i]);
+        kept++;
+    }
+    return kept;
+}
+
+// Prints the spread of a configuration's samples
+void printSampleStats(const std::string& tag, const SampleStats& stats) {
+    std::cout << tag << "  Median: " << stats.GetMedian() << ", Std Dev: " << stats.GetStdDev() << ", 95% CI: ±" << stats.GetConfidenceInterval()
+              << " (" << stats.GetCount() << " iterations, " << stats.GetOutlierCount() << " outliers)" << std::endl;
+}
+
 // Runs tests and measures throughput, and outputs to console that throughput is being measured and the exact numbers
-template<typename... TQueues>
-void runThroughput(const BenchmarkSuiteConfig& config, const std::string& basepath) {
+void runThroughput(const BenchmarkSuite& suite, const std::vector<const QueueRegistration*>& queues, JobPoolFactory jobPool) {
+    const BenchmarkSuiteConfig& config = suite.config;
     for (const auto& jobCount : config.jobCounts) {
         std::cout << "============================================================" << std::endl;
-        std::cout << "[Throughput] Running benchmark for " << formatJobCount(jobCount) << " jobs." << std::endl;
+        std::cout << "[Throughput] Running benchmark for " << formatJobCount(jobCount) << " jobs (batch size " << config.batchSize << ")." << std::endl;
         std::cout << "============================================================" << std::endl;
 
-        std::vector<std::tuple<std::string /*queueName*/, int /*threadCount*/, double /*avgThroughput*/>> rows;
+        std::vector<std::tuple<std::string /*queueName*/, int /*threadCount*/, double /*avgThroughput*/, double /*medianThroughput*/,
+                               double /*stdDev*/, double /*ci95*/, double /*avgSteals*/, double /*avgFullEnqueues*/, double /*avgDropped*/,
+                               double /*avgCpuTime*/, double /*avgCpuUtilization*/, size_t /*iterations*/, size_t /*outliers*/>> rows;
 
-        size_t totalTestConfigs = config.producerCounts.size() * sizeof...(TQueues);
+        std::vector<QueueRun> runs = expandCapacities(queues, config);
+        size_t totalTestConfigs = config.producerCounts.size() * runs.size();
         size_t testConfigI = 1;
 
-        ([&](auto* ptr) {
-            using QueueType = std::remove_reference_t<decltype(*ptr)>;
-            std::cout << "[Throughput] Benchmarking Queue: " << QueueType::GetName() << std::endl;
+        for (const QueueRun& run : runs) {
+            const QueueRegistration* queue = run.queue;
+            std::cout << "[Throughput] Benchmarking Queue: " << run.name << std::endl;
 
             for (size_t i = 0; i < config.producerCounts.size(); ++i) {
                 int producerCount = config.producerCounts[i];
                 int consumerCount = config.consumerCounts[i];
 
                 std::cout << "[Throughput]  Config: " << producerCount << "P" << consumerCount << "C (" << testConfigI++ << "/" << totalTestConfigs << ")" << std::endl;
+                if (!queue->supportsThreadCounts(producerCount, consumerCount)) {
+                    std::cout << "[Throughput]   Skipped, queue does not support this many producers/consumers" << std::endl;
+                    continue;
+                }
 
-                double totalThroughput = 0.0;
-                for (int iteration = 1; iteration <= config.iterations; iteration++) {
-                    std::cout << "[Throughput]   Iteration " << iteration << "/" << config.iterations << "...";
-                    Benchmark<QueueType> benchmark;
-                    auto result = benchmark.RunThroughput(jobCount, producerCount, consumerCount);
+                std::vector<ThroughputResult> results;
+                // samples are throughput per thread
+                SampleStats stats = runIterations("[Throughput]", config, [&](bool measured) {
+                    auto result = queue->runThroughput(jobPool, run.capacity, jobCount, producerCount, consumerCount, config.batchSize, {});
 
                     auto numJobsCompleted = result.numJobsCompleted;
                     std::chrono::duration<double, std::chrono::seconds::period> elapsedSeconds = result.elapsed;
                     auto throughput = numJobsCompleted / elapsedSeconds.count();
-                    totalThroughput += throughput;
-                    std::cout << " Throughput: " << formatThroughput(throughput, 3) << " jobs/second" << std::endl;
-                }
-
-                double avgThroughput = totalThroughput / config.iterations;
-                double throughputPerThread = avgThroughput / (producerCount + consumerCount);
-                std::cout << "[Throughput]  Average Throughput: " << formatThroughput(avgThroughput, 3) << " jobs/second" << std::endl;
-                std::cout << "[Throughput]  Throughput per thread: " << formatThroughput(throughputPerThread, 3) << " jobs/second/thread" << std::endl;
-                rows.emplace_back(QueueType::GetName(), std::max(producerCount, consumerCount), throughputPerThread);
+                    std::chrono::duration<double, std::milli> cpuMs = result.cpuTime;
+                    if (measured) results.push_back(result);
+                    std::cout << " Throughput: " << formatThroughput(throughput, 3) << " jobs/second";
+                    if (result.numSteals > 0) std::cout << ", Steals: " << result.numSteals;
+                    if (result.numFullEnqueues > 0) std::cout << ", Full: " << result.numFullEnqueues;
+                    if (result.numDropped > 0) std::cout << ", Dropped: " << result.numDropped;
+                    std::cout << ", CPU: " << cpuMs.count() << " ms (" << cpuMs.count() / 1000.0 / elapsedSeconds.count() << " cores)" << std::endl;
+                    return throughput / (producerCount + consumerCount);
+                });
+
+                double totalSteals = 0.0;
+                double totalFullEnqueues = 0.0;
+                double totalDropped = 0.0;
+                double totalCpuMs = 0.0;
+                double totalCpuUtilization = 0.0;
+                double iterations = (double)forEachKept(stats, results, [&](const ThroughputResult& result) {
+                    std::chrono::duration<double, std::chrono::seconds::period> elapsedSeconds = result.elapsed;
+                    std::chrono::duration<double, std::milli> cpuMs = result.cpuTime;
+                    totalSteals += result.numSteals;
+                    totalFullEnqueues += result.numFullEnqueues;
+                    totalDropped += result.numDropped;
+                    totalCpuMs += cpuMs.count();
+                    totalCpuUtilization += cpuMs.count() / 1000.0 / elapsedSeconds.count();
+                });
+                double throughputPerThread = stats.GetMean();
+                double avgSteals = totalSteals / iterations;
+                double avgFullEnqueues = totalFullEnqueues / iterations;
+                double avgDropped = totalDropped / iterations;
+                double avgCpuMs = totalCpuMs / iterations;
+                double avgCpuUtilization = totalCpuUtilization / iterations;
+                std::cout << "[Throughput]  Average Throughput: " << formatThroughput(throughputPerThread * (producerCount + consumerCount), 3) << " jobs/second" << std::endl;
+                std::cout << "[Throughput]  Throughput per thread: " << formatThroughput(throughputPerThread, 3) << " jobs/second/thread ± "
+                          << formatThroughput(stats.GetConfidenceInterval(), 3) << " (95% CI)" << std::endl;
+                printSampleStats("[Throughput]", stats);
+                std::cout << "[Throughput]  Average CPU: " << avgCpuMs << " ms (" << avgCpuUtilization << " cores)" << std::endl;
+                rows.emplace_back(run.name, std::max(producerCount, consumerCount), throughputPerThread, stats.GetMedian(), stats.GetStdDev(),
+                                  stats.GetConfidenceInterval(), avgSteals, avgFullEnqueues, avgDropped, avgCpuMs, avgCpuUtilization,
+                                  stats.GetCount(), stats.GetOutlierCount());
             }
-        }(static_cast<TQueues*>(nullptr)), ...);
+        }
 
-        auto path = basepath + "_job_count_" + formatJobCount(jobCount) + ".csv";
-        static std::array<std::string, 3> header{
+        auto path = suite.outputBasePath + "_job_count_" + formatJobCount(jobCount) + ".csv";
+        static std::array<std::string, 13> header{
                 "Queue",
                 "Producer/Consumer Count",
-                "Average Throughput per Thread (jobs/sec/thread)"
+                "Average Throughput per Thread (jobs/sec/thread)",
+                "Median Throughput per Thread (jobs/sec/thread)",
+                "Throughput per Thread Std Dev (jobs/sec/thread)",
+                "Throughput per Thread 95% CI (+/- jobs/sec/thread)",
+                "Average Steals",
+                "Average Full Enqueues",
+                "Average Dropped Jobs",
+                "Average CPU Time (ms)",
+                "Average CPU Utilization (cores)",
+                "Iterations",
+                "Outlier Iterations"
         };
         writeCsv(path, header, rows);
         std::cout << "[Throughput] Saved results to " << path << std::endl;
@@ -143,67 +369,352 @@ void runThroughput(const BenchmarkSuiteConfig& config, const std::string& basepa
 }
 
 // Runs latency tests, and outputs to console what tests are being performed and the data being collected
-template<typename... TQueues>
-void runLatency(const BenchmarkSuiteConfig& config, const std::string& basepath) {
+void runLatency(const BenchmarkSuite& suite, const std::vector<const QueueRegistration*>& queues, JobPoolFactory jobPool) {
+    const BenchmarkSuiteConfig& config = suite.config;
     for (const auto& jobCount : config.jobCounts) {
         std::cout << "============================================================" << std::endl;
-        std::cout << "[Latency] Running benchmark for " << formatJobCount(jobCount) << " jobs." << std::endl;
+        std::cout << "[Latency] Running benchmark for " << formatJobCount(jobCount) << " jobs (batch size " << config.batchSize << ")." << std::endl;
         std::cout << "============================================================" << std::endl;
 
-        std::vector<std::tuple<std::string /*queueName*/, int /*threadCount*/, double /*avgLatency*/>> rows;
+        std::vector<std::tuple<std::string /*queueName*/, int /*threadCount*/, double /*avgLatency*/,
+                               double /*medianAvgLatency*/, double /*stdDev*/, double /*ci95*/,
+                               uint64_t /*p50*/, uint64_t /*p90*/, uint64_t /*p99*/, uint64_t /*p99.9*/, uint64_t /*p99.99*/, uint64_t /*max*/,
+                               double /*avgCpuTime*/, double /*avgCpuUtilization*/, size_t /*iterations*/, size_t /*outliers*/>> rows;
 
-        size_t totalTestConfigs = config.producerCounts.size() * sizeof...(TQueues);
+        std::vector<QueueRun> runs = expandCapacities(queues, config);
+        size_t totalTestConfigs = config.producerCounts.size() * runs.size();
         size_t testConfigI = 1;
 
-        ([&](auto* ptr) {
-            using QueueType = std::remove_reference_t<decltype(*ptr)>;
-            std::cout << "[Latency] Benchmarking Queue: " << QueueType::GetName() << std::endl;
+        for (const QueueRun& run : runs) {
+            const QueueRegistration* queue = run.queue;
+            std::cout << "[Latency] Benchmarking Queue: " << run.name << std::endl;
 
             for (size_t i = 0; i < config.producerCounts.size(); ++i) {
                 int producerCount = config.producerCounts[i];
                 int consumerCount = config.consumerCounts[i];
 
                 std::cout << "[Latency]  Config: " << producerCount << "P" << consumerCount << "C (" << testConfigI++ << "/" << totalTestConfigs << ")" << std::endl;
+                if (!queue->supportsThreadCounts(producerCount, consumerCount)) {
+                    std::cout << "[Latency]   Skipped, queue does not support this many producers/consumers" << std::endl;
+                    continue;
+                }
+
+                std::vector<LatencyResult> results;
+                // samples are each iteration's average latency
+                SampleStats stats = runIterations("[Latency]", config, [&](bool measured) {
+                    auto result = queue->runLatency(jobPool, run.capacity, jobCount, producerCount, consumerCount, config.batchSize, {});
+
+                    double avg_ns = result.latencies.GetMean();
+                    std::chrono::duration<double, std::milli> cpuMs = result.cpuTime;
+                    std::chrono::duration<double, std::milli> elapsedMs = result.elapsed;
+                    std::cout << " Avg Latency: " << avg_ns << " ns, p99: " << result.latencies.GetValueAtPercentile(99.0) << " ns, CPU: " << cpuMs.count() << " ms (" << cpuMs.count() / elapsedMs.count() << " cores)" << std::endl;
+                    if (measured) results.push_back(std::move(result));
+                    return avg_ns;
+                });
+
+                double totalCpuMs = 0.0;
+                double totalCpuUtilization = 0.0;
+                // percentiles are taken over every kept iteration's latencies together
+                LatencyHistogram allLatencies;
+                double iterations = (double)forEachKept(stats, results, [&](const LatencyResult& result) {
+                    std::chrono::duration<double, std::milli> cpuMs = result.cpuTime;
+                    std::chrono::duration<double, std::milli> elapsedMs = result.elapsed;
+                    allLatencies.Merge(result.latencies);
+                    totalCpuMs += cpuMs.count();
+                    totalCpuUtilization += cpuMs.count() / elapsedMs.count();
+                });
+                double avgLatency = stats.GetMean();
+                double avgCpuMs = totalCpuMs / iterations;
+                double avgCpuUtilization = totalCpuUtilization / iterations;
+                rows.emplace_back(run.name, std::max(producerCount, consumerCount), avgLatency,
+                                  stats.GetMedian(), stats.GetStdDev(), stats.GetConfidenceInterval(),
+                                  allLatencies.GetValueAtPercentile(50.0), allLatencies.GetValueAtPercentile(90.0),
+                                  allLatencies.GetValueAtPercentile(99.0), allLatencies.GetValueAtPercentile(99.9),
+                                  allLatencies.GetValueAtPercentile(99.99), allLatencies.GetMax(),
+                                  avgCpuMs, avgCpuUtilization, stats.GetCount(), stats.GetOutlierCount());
+                std::cout << "[Latency]  Average Latency: " << avgLatency << " ns ± " << stats.GetConfidenceInterval() << " ns (95% CI)" << std::endl;
+                printSampleStats("[Latency]", stats);
+                std::cout << "[Latency]  p50: " << allLatencies.GetValueAtPercentile(50.0) << " ns, p99: " << allLatencies.GetValueAtPercentile(99.0)
+                          << " ns, p99.99: " << allLatencies.GetValueAtPercentile(99.99) << " ns, max: " << allLatencies.GetMax() << " ns" << std::endl;
+                std::cout << "[Latency]  Average CPU: " << avgCpuMs << " ms (" << avgCpuUtilization << " cores)" << std::endl;
+            }
+        }
+
+        auto path = suite.outputBasePath + "_job_count_" + formatJobCount(jobCount) + ".csv";
+        static std::array<std::string, 16> header{
+                "Queue",
+                "Producer/Consumer Count",
+                "Average Latency (ns)",
+                "Median Average Latency (ns)",
+                "Average Latency Std Dev (ns)",
+                "Average Latency 95% CI (+/- ns)",
+                "p50 Latency (ns)",
+                "p90 Latency (ns)",
+                "p99 Latency (ns)",
+                "p99.9 Latency (ns)",
+                "p99.99 Latency (ns)",
+                "Max Latency (ns)",
+                "Average CPU Time (ms)",
+                "Average CPU Utilization (cores)",
+                "Iterations",
+                "Outlier Iterations"
+        };
+        writeCsv(path, header, rows);
+        std::cout << "[Latency] Saved results to " << path << std::endl;
+    }
+}
 
-                double totalAvgLatency = 0.0;
-                for (int iteration = 1; iteration <= config.iterations; iteration++) {
-                    std::cout << "[Latency]   Iteration " << iteration << "/" << config.iterations << "...";
-                    Benchmark<QueueType> benchmark;
-                    auto result = benchmark.RunLatency(jobCount, producerCount, consumerCount);
+// Runs latency tests with producers offering each of the suite's loads in turn, open loop, so the results show latency
+// at a given load (flat while the queue keeps up, climbing once it saturates) rather than only at saturation
+void runLoad(const BenchmarkSuite& suite, const std::vector<const QueueRegistration*>& queues, JobPoolFactory jobPool) {
+    const BenchmarkSuiteConfig& config = suite.config;
+    for (const auto& jobCount : config.jobCounts) {
+        std::cout << "============================================================" << std::endl;
+        std::cout << "[Load] Running benchmark for " << formatJobCount(jobCount) << " jobs (" << SuiteFile::ArrivalName(config.arrivalPattern)
+                  << " arrivals, batch size " << config.batchSize << ")." << std::endl;
+        std::cout << "============================================================" << std::endl;
+
+        std::vector<std::tuple<std::string /*queueName*/, int /*threadCount*/, double /*offeredLoad*/, double /*achievedThroughput*/,
+                               double /*avgLatency*/, uint64_t /*p50*/, uint64_t /*p90*/, uint64_t /*p99*/, uint64_t /*p99.9*/, uint64_t /*max*/,
+                               double /*avgCorrectedLatency*/, uint64_t /*p50*/, uint64_t /*p90*/, uint64_t /*p99*/, uint64_t /*p99.9*/, uint64_t /*max*/,
+                               double /*avgCpuUtilization*/>> rows;
+
+        std::vector<QueueRun> runs = expandCapacities(queues, config);
+        size_t totalTestConfigs = config.producerCounts.size() * config.offeredLoads.size() * runs.size();
+        size_t testConfigI = 1;
 
-                    double sum_ns = 0;
-                    for (const auto& l : result.latencies) {
-                        sum_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(l).count();
+        for (const QueueRun& run : runs) {
+            const QueueRegistration* queue = run.queue;
+            std::cout << "[Load] Benchmarking Queue: " << run.name << std::endl;
+
+            for (size_t i = 0; i < config.producerCounts.size(); ++i) {
+                int producerCount = config.producerCounts[i];
+                int consumerCount = config.consumerCounts[i];
+
+                for (double offeredLoad : config.offeredLoads) {
+                    std::cout << "[Load]  Config: " << producerCount << "P" << consumerCount << "C at " << formatThroughput(offeredLoad, 0)
+                              << " jobs/second (" << testConfigI++ << "/" << totalTestConfigs << ")" << std::endl;
+                    if (!queue->supportsThreadCounts(producerCount, consumerCount)) {
+                        std::cout << "[Load]   Skipped, queue does not support this many producers/consumers" << std::endl;
+                        continue;
                     }
-                    double avg_ns = result.latencies.empty() ? 0 : sum_ns / result.latencies.size();
 
-                    totalAvgLatency += avg_ns;
-                    std::cout << " Avg Latency: " << avg_ns << " ns" << std::endl;
+                    ArrivalRate rate { config.arrivalPattern, offeredLoad };
+                    std::vector<LatencyResult> results;
+                    // samples are each iteration's average latency
+                    SampleStats stats = runIterations("[Load]", config, [&](bool measured) {
+                        auto result = queue->runLatency(jobPool, run.capacity, jobCount, producerCount, consumerCount, config.batchSize, rate);
+
+                        std::chrono::duration<double, std::chrono::seconds::period> elapsedSeconds = result.elapsed;
+                        double throughput = jobCount / elapsedSeconds.count();
+                        std::chrono::duration<double, std::milli> cpuMs = result.cpuTime;
+                        double cpuUtilization = cpuMs.count() / 1000.0 / elapsedSeconds.count();
+                        std::cout << " Achieved: " << formatThroughput(throughput, 3) << " jobs/second, Avg Latency: " << result.latencies.GetMean()
+                                  << " ns, p99: " << result.latencies.GetValueAtPercentile(99.0) << " ns, Corrected p99: "
+                                  << result.correctedLatencies.GetValueAtPercentile(99.0) << " ns, CPU: " << cpuUtilization << " cores" << std::endl;
+                        double avgLatency = result.latencies.GetMean();
+                        if (measured) results.push_back(std::move(result));
+                        return avgLatency;
+                    });
+
+                    double totalAvgCorrectedLatency = 0.0;
+                    double totalThroughput = 0.0;
+                    double totalCpuUtilization = 0.0;
+                    LatencyHistogram allLatencies;
+                    LatencyHistogram allCorrectedLatencies;
+                    double iterations = (double)forEachKept(stats, results, [&](const LatencyResult& result) {
+                        std::chrono::duration<double, std::chrono::seconds::period> elapsedSeconds = result.elapsed;
+                        std::chrono::duration<double, std::milli> cpuMs = result.cpuTime;
+                        totalAvgCorrectedLatency += result.correctedLatencies.GetMean();
+                        totalThroughput += jobCount / elapsedSeconds.count();
+                        totalCpuUtilization += cpuMs.count() / 1000.0 / elapsedSeconds.count();
+                        allLatencies.Merge(result.latencies);
+                        allCorrectedLatencies.Merge(result.correctedLatencies);
+                    });
+                    double avgLatency = stats.GetMean();
+                    double avgCorrectedLatency = totalAvgCorrectedLatency / iterations;
+                    double avgThroughput = totalThroughput / iterations;
+                    double avgCpuUtilization = totalCpuUtilization / iterations;
+                    rows.emplace_back(run.name, std::max(producerCount, consumerCount), offeredLoad, avgThroughput, avgLatency,
+                                      allLatencies.GetValueAtPercentile(50.0), allLatencies.GetValueAtPercentile(90.0),
+                                      allLatencies.GetValueAtPercentile(99.0), allLatencies.GetValueAtPercentile(99.9), allLatencies.GetMax(),
+                                      avgCorrectedLatency, allCorrectedLatencies.GetValueAtPercentile(50.0),
+                                      allCorrectedLatencies.GetValueAtPercentile(90.0), allCorrectedLatencies.GetValueAtPercentile(99.0),
+                                      allCorrectedLatencies.GetValueAtPercentile(99.9), allCorrectedLatencies.GetMax(),
+                                      avgCpuUtilization);
+                    std::cout << "[Load]  Achieved: " << formatThroughput(avgThroughput, 3) << " jobs/second, Average Latency: " << avgLatency
+                              << " ns, p99: " << allLatencies.GetValueAtPercentile(99.0) << " ns, Corrected p99: "
+                              << allCorrectedLatencies.GetValueAtPercentile(99.0) << " ns" << std::endl;
                 }
+            }
+        }
+
+        auto path = suite.outputBasePath + "_job_count_" + formatJobCount(jobCount) + ".csv";
+        static std::array<std::string, 17> header{
+                "Queue",
+                "Producer/Consumer Count",
+                "Offered Load (jobs/sec)",
+                "Achieved Throughput (jobs/sec)",
+                "Average Latency (ns)",
+                "p50 Latency (ns)",
+                "p90 Latency (ns)",
+                "p99 Latency (ns)",
+                "p99.9 Latency (ns)",
+                "Max Latency (ns)",
+                "Corrected Average Latency (ns)",
+                "Corrected p50 Latency (ns)",
+                "Corrected p90 Latency (ns)",
+                "Corrected p99 Latency (ns)",
+                "Corrected p99.9 Latency (ns)",
+                "Corrected Max Latency (ns)",
+                "Average CPU Utilization (cores)"
+        };
+        writeCsv(path, header, rows);
+        std::cout << "[Load] Saved results to " << path << std::endl;
+    }
+}
+
+// Runs throughput tests for queues that take a memory reclamation policy, also recording the most retired nodes that
+// were waiting to be freed at once
+void runReclamation(const BenchmarkSuite& suite, const std::vector<const QueueRegistration*>& queues, JobPoolFactory jobPool) {
+    const BenchmarkSuiteConfig& config = suite.config;
+    for (const auto& jobCount : config.jobCounts) {
+        std::cout << "============================================================" << std::endl;
+        std::cout << "[Reclamation] Running benchmark for " << formatJobCount(jobCount) << " jobs." << std::endl;
+        std::cout << "============================================================" << std::endl;
 
-                double avgLatency = totalAvgLatency / config.iterations;
-                rows.emplace_back(QueueType::GetName(), std::max(producerCount, consumerCount), avgLatency);
-                std::cout << "[Latency]  Average Latency: " << avgLatency << " ns" << std::endl;
+        std::vector<std::tuple<std::string /*queueName*/, int /*threadCount*/, double /*avgThroughput*/, size_t /*retiredHighWater*/, size_t /*retiredHighWaterBytes*/>> rows;
+
+        std::vector<QueueRun> runs = expandCapacities(queues, config);
+        size_t totalTestConfigs = config.producerCounts.size() * runs.size();
+        size_t testConfigI = 1;
+
+        for (const QueueRun& run : runs) {
+            const QueueRegistration* queue = run.queue;
+            std::cout << "[Reclamation] Benchmarking Queue: " << run.name << std::endl;
+
+            for (size_t i = 0; i < config.producerCounts.size(); ++i) {
+                int producerCount = config.producerCounts[i];
+                int consumerCount = config.consumerCounts[i];
+
+                std::cout << "[Reclamation]  Config: " << producerCount << "P" << consumerCount << "C (" << testConfigI++ << "/" << totalTestConfigs << ")" << std::endl;
+                if (!queue->supportsThreadCounts(producerCount, consumerCount)) {
+                    std::cout << "[Reclamation]   Skipped, queue does not support this many producers/consumers" << std::endl;
+                    continue;
+                }
+
+                std::vector<size_t> highWaters;
+                // samples are throughput per thread
+                SampleStats stats = runIterations("[Reclamation]", config, [&](bool measured) {
+                    queue->resetReclamationStats();
+                    auto result = queue->runThroughput(jobPool, run.capacity, jobCount, producerCount, consumerCount, config.batchSize, {});
+
+                    std::chrono::duration<double, std::chrono::seconds::period> elapsedSeconds = result.elapsed;
+                    auto throughput = result.numJobsCompleted / elapsedSeconds.count();
+                    if (measured) highWaters.push_back(queue->getRetiredHighWater());
+                    std::cout << " Throughput: " << formatThroughput(throughput, 3) << " jobs/second, Retired high-water: " << queue->getRetiredHighWater() << " nodes" << std::endl;
+                    return throughput / (producerCount + consumerCount);
+                });
+
+                size_t retiredHighWater = 0;
+                forEachKept(stats, highWaters, [&](size_t highWater) { retiredHighWater = std::max(retiredHighWater, highWater); });
+                double throughputPerThread = stats.GetMean();
+                std::cout << "[Reclamation]  Throughput per thread: " << formatThroughput(throughputPerThread, 3) << " jobs/second/thread" << std::endl;
+                printSampleStats("[Reclamation]", stats);
+                std::cout << "[Reclamation]  Retired high-water: " << retiredHighWater << " nodes (" << retiredHighWater * queue->nodeSize << " bytes)" << std::endl;
+                rows.emplace_back(run.name, std::max(producerCount, consumerCount), throughputPerThread, retiredHighWater, retiredHighWater * queue->nodeSize);
             }
-        }(static_cast<TQueues*>(nullptr)), ...);
+        }
 
-        auto path = basepath + "_job_count_" + formatJobCount(jobCount) + ".csv";
-        static std::array<std::string, 3> header{
+        auto path = suite.outputBasePath + "_job_count_" + formatJobCount(jobCount) + ".csv";
+        static std::array<std::string, 5> header{
                 "Queue",
                 "Producer/Consumer Count",
-                "Average Latency (ns)"
+                "Average Throughput per Thread (jobs/sec/thread)",
+                "Retired High-Water (nodes)",
+                "Retired High-Water (bytes)"
         };
         writeCsv(path, header, rows);
-        std::cout << "[Latency] Saved results to " << path << std::endl;
+        std::cout << "[Reclamation] Saved results to " << path << std::endl;
+    }
+}
+
+// Prints the available suites, queue ids and job pools for --list
+void printList(const std::vector<BenchmarkSuite>& suites, const QueueRegistry& registry) {
+    std::cout << "Suites (* runs by default):" << std::endl;
+    for (const BenchmarkSuite& suite : suites) {
+        std::cout << "  " << (suite.enabledByDefault ? "* " : "  ") << suite.name << " (" << SuiteFile::TypeName(suite.type) << ", "
+                  << suite.queues.size() << " queues) -> " << suite.outputBasePath << std::endl;
+    }
+    std::cout << "Queues:" << std::endl;
+    for (const QueueRegistration& queue : registry.GetAll()) {
+        std::cout << "  " << queue.id << " - " << queue.name << (queue.resetReclamationStats ? " [reclamation]" : "") << std::endl;
     }
+    std::cout << "Job pools:" << std::endl;
+    for (const auto& pool : jobPoolFactories()) {
+        std::cout << "  " << pool.first << std::endl;
+    }
+}
+
+// Looks up every queue in the suite, so a typo fails before anything has run
+std::vector<const QueueRegistration*> resolveQueues(const BenchmarkSuite& suite, const QueueRegistry& registry) {
+    std::vector<const QueueRegistration*> queues;
+    for (const std::string& id : suite.queues) {
+        const QueueRegistration* queue = registry.Find(id);
+        if (queue == nullptr) throw std::runtime_error("Suite '" + suite.name + "' uses unknown queue '" + id + "', see --list");
+        if (suite.type == BenchmarkType::Reclamation && queue->resetReclamationStats == nullptr) {
+            throw std::runtime_error("Suite '" + suite.name + "' is a reclamation suite but queue '" + id + "' has no reclamation policy");
+        }
+        queues.push_back(queue);
+    }
+    return queues;
+}
+
+JobPoolFactory resolveJobPool(const BenchmarkSuite& suite) {
+    auto it = jobPoolFactories().find(suite.jobPool);
+    if (it == jobPoolFactories().end()) throw std::runtime_error("Suite '" + suite.name + "' uses unknown job pool '" + suite.jobPool + "', see --list");
+    return it->second;
 }
 
-int main() {
-#if defined(ENABLE_THROUGHPUT_BENCHMARK)
-    runThroughput<LinkedListQueue<Job*>, BoundedCircularBufferQueue<Job*, 4>, BoundedCircularBufferQueue<Job*, 16>, MoodycamelQueue<Job*>, StdQueueBlocking<Job*>>(THROUGHPUT_CONFIG, THROUGHPUT_BASEPATH);
-#endif
-#if defined(ENABLE_LATENCY_BENCHMARK)
-    runLatency<LinkedListQueue<Job*>, BoundedCircularBufferQueue<Job*, 4>, BoundedCircularBufferQueue<Job*, 16>, MoodycamelQueue<Job*>, StdQueueBlocking<Job*>>(LATENCY_CONFIG, LATENCY_BASEPATH);
-#endif
+int main(int argc, char** argv) {
+    QueueRegistry registry = registerQueues();
+
+    std::vector<BenchmarkSuite> suites;
+    std::vector<std::pair<std::vector<const QueueRegistration*>, JobPoolFactory>> resolved;
+    try {
+        CommandLineOptions options = CommandLine::Parse(argc, argv);
+        if (options.help) {
+            CommandLine::PrintUsage(std::cout);
+            return 0;
+        }
+
+        std::vector<BenchmarkSuite> available = options.configPath.empty() ? defaultSuites() : SuiteFile::Load(options.configPath);
+        if (options.list) {
+            printList(available, registry);
+            return 0;
+        }
+
+        suites = CommandLine::SelectSuites(options, available);
+        for (const BenchmarkSuite& suite : suites) {
+            resolved.emplace_back(resolveQueues(suite, registry), resolveJobPool(suite));
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    // also calibrates the clock before the first benchmark
+    std::cout << "[Clock] Timing with " << TscClock::GetName() << std::endl;
+
+    for (size_t i = 0; i < suites.size(); i++) {
+        const BenchmarkSuite& suite = suites[i];
+        std::cout << "[Suite] " << suite.name << std::endl;
+        switch (suite.type) {
+            case BenchmarkType::Throughput: runThroughput(suite, resolved[i].first, resolved[i].second); break;
+            case BenchmarkType::Latency: runLatency(suite, resolved[i].first, resolved[i].second); break;
+            case BenchmarkType::Reclamation: runReclamation(suite, resolved[i].first, resolved[i].second); break;
+            case BenchmarkType::Load: runLoad(suite, resolved[i].first, resolved[i].second); break;
+        }
+    }
     return 0;
 }